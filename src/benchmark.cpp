@@ -19,11 +19,22 @@
 #include "benchmark.h"
 #include "numa.h"
 
+#include <array>
+#include <chrono>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <utility>
 #include <vector>
 
+#include "history.h"
+#include "memory.h"
+#include "misc.h"
+#include "movegen.h"
+#include "movepick.h"
+#include "position.h"
+
 namespace {
 
 // clang-format off
@@ -372,6 +383,62 @@ const std::vector<std::vector<std::string>> BenchmarkPositions = {
 };
 // clang-format on
 
+// Fills a history table with values spread over the whole range allowed by
+// its entries, so that the move picker has realistic sorting work to do.
+template<typename T, int D, bool Atomic>
+void randomize(Stockfish::StatsEntry<T, D, Atomic>& entry, Stockfish::PRNG& rng) {
+    entry = T(int(rng.rand<std::uint32_t>() % (2 * D + 1)) - D);
+}
+
+template<typename T, std::size_t... Sizes>
+void randomize(Stockfish::MultiArray<T, Sizes...>& table, Stockfish::PRNG& rng) {
+    for (auto& child : table)
+        randomize(child, rng);
+}
+
+bool is_packed_file(const std::string& file) {
+    const std::string ext = ".packed";
+    return file.size() > ext.size() && file.compare(file.size() - ext.size(), ext.size(), ext) == 0;
+}
+
+// A position of the speedtest games, with the StateInfo it was set up with
+struct SetupPosition {
+    std::unique_ptr<Stockfish::Position>  pos = std::make_unique<Stockfish::Position>();
+    std::unique_ptr<Stockfish::StateInfo> st  = std::make_unique<Stockfish::StateInfo>();
+};
+
+std::vector<SetupPosition> speedtest_positions() {
+    std::vector<SetupPosition> positions;
+
+    for (const auto& game : BenchmarkPositions)
+        for (const std::string& fen : game)
+        {
+            SetupPosition& p = positions.emplace_back();
+            p.pos->set(fen, false, p.st.get());
+        }
+
+    return positions;
+}
+
+// Runs the given function, which returns its number of operations, the given
+// number of times and records the time taken under the given name.
+template<typename Func>
+void time_primitive(std::vector<Stockfish::Benchmark::PrimitiveStats>& stats,
+                    const char*                                         name,
+                    int                                                 iterations,
+                    Func&&                                              func) {
+    Stockfish::Benchmark::PrimitiveStats s{name, 0, 0, 0};
+    auto                                 start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < iterations; ++i)
+        s.ops += func(s.results);
+
+    s.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+    stats.push_back(s);
+}
+
 }  // namespace
 
 namespace Stockfish::Benchmark {
@@ -387,7 +454,14 @@ namespace Stockfish::Benchmark {
 // bench 64 1 100000 default nodes  : search default positions for 100K nodes each
 // bench 64 4 5000 current movetime : search current position with 4 threads for 5 sec
 // bench 16 1 5 blah perft          : run a perft 5 on positions in file "blah"
-std::vector<std::string> setup_bench(const std::string& currentFen, std::istream& is) {
+//
+// A file with the .packed extension is read as packed positions, as written
+// by pack_positions(), instead of FENs. They are returned in packed rather than
+// converted to text, and the list has a "position packed" command without
+// argument where the next one of them is to be set up.
+std::vector<std::string> setup_bench(const std::string&           currentFen,
+                                     std::istream&                is,
+                                     std::vector<PackedPosition>& packed) {
 
     std::vector<std::string> fens, list;
     std::string              go, token;
@@ -407,6 +481,30 @@ std::vector<std::string> setup_bench(const std::string& currentFen, std::istream
     else if (fenFile == "current")
         fens.push_back(currentFen);
 
+    else if (is_packed_file(fenFile))
+    {
+        PackedPosition pp;
+        std::ifstream  file(fenFile, std::ios::binary);
+
+        if (!file.is_open())
+        {
+            std::cerr << "Unable to open file " << fenFile << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        while (file.read(reinterpret_cast<char*>(pp.bytes.data()), pp.bytes.size()))
+        {
+            if (!pp.is_valid())
+            {
+                std::cerr << "Invalid packed position " << packed.size() + 1 << " in "
+                          << fenFile << std::endl;
+                exit(EXIT_FAILURE);
+            }
+
+            packed.push_back(pp);
+        }
+    }
+
     else
     {
         std::string   fen;
@@ -438,9 +536,42 @@ std::vector<std::string> setup_bench(const std::string& currentFen, std::istream
             list.emplace_back(go);
         }
 
+    for (std::size_t i = 0; i < packed.size(); ++i)
+    {
+        list.emplace_back("position packed");
+        list.emplace_back(go);
+    }
+
     return list;
 }
 
+// Converts a file of FENs, one per line, to a file of packed positions which
+// bench and analyse read many times faster. Any moves after a FEN are ignored.
+std::int64_t
+pack_positions(const std::string& fenFile, const std::string& packedFile, bool chess960) {
+
+    std::ifstream in(fenFile);
+    std::ofstream out(packedFile, std::ios::binary);
+
+    if (!in.is_open() || !out.is_open())
+        return -1;
+
+    std::int64_t count = 0;
+    std::string  fen;
+    StateInfo    st;
+    Position     pos;
+
+    while (getline(in, fen))
+        if (!fen.empty() && fen.find("setoption") == std::string::npos)
+        {
+            PackedPosition pp = pos.set(fen, chess960, &st).pack();
+            out.write(reinterpret_cast<const char*>(pp.bytes.data()), pp.bytes.size());
+            ++count;
+        }
+
+    return count;
+}
+
 BenchmarkSetup setup_benchmark(std::istream& is) {
     // TT_SIZE_PER_THREAD is chosen such that roughly half of the hash is used all positions
     // for the current sequence have been searched.
@@ -512,4 +643,182 @@ BenchmarkSetup setup_benchmark(std::istream& is) {
     return setup;
 }
 
+// Runs the move picker of the main search and of qsearch to exhaustion on
+// every position of the speedtest games, the given number of times, and
+// measures the time spent generating, scoring, sorting and selecting moves.
+MovePickStats movepick_speed(int iterations) {
+
+    auto mainHistory         = make_unique_large_page<ButterflyHistory>();
+    auto lowPlyHistory       = make_unique_large_page<LowPlyHistory>();
+    auto captureHistory      = make_unique_large_page<CapturePieceToHistory>();
+    auto continuationHistory = make_unique_large_page<ContinuationHistory>();
+    auto sharedHistory       = std::make_unique<SharedHistories>(1);
+
+    PRNG rng(1070372);
+    randomize(*mainHistory, rng);
+    randomize(*lowPlyHistory, rng);
+    randomize(*captureHistory, rng);
+    randomize(*continuationHistory, rng);
+
+    std::vector<SetupPosition>                        setups = speedtest_positions();
+    std::vector<std::array<const PieceToHistory*, 6>> contHists(setups.size());
+
+    for (std::size_t i = 0; i < setups.size(); ++i)
+    {
+        randomize(sharedHistory->pawn_entry(*setups[i].pos), rng);
+
+        for (auto& ch : contHists[i])
+            ch = &(*continuationHistory)[rng.rand<unsigned>() % PIECE_NB]
+                                        [rng.rand<unsigned>() % SQUARE_NB];
+    }
+
+    MovePickStats stats;
+    auto          start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < iterations; ++i)
+        for (std::size_t j = 0; j < setups.size(); ++j)
+            for (Depth depth : {10, 1, DEPTH_QS})
+            {
+                MovePicker mp(*setups[j].pos, Move::none(), depth, mainHistory.get(),
+                              lowPlyHistory.get(), captureHistory.get(), contHists[j].data(),
+                              sharedHistory.get(), 2);
+
+                while (mp.next_move())
+                    ++stats.moves;
+
+                ++stats.positions;
+            }
+
+    stats.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+
+    return stats;
+}
+
+// Times the position primitives used by the search one at a time, over all the
+// positions of the speedtest games. The moves are generated beforehand so that
+// only the primitive itself is measured.
+std::vector<PrimitiveStats> position_speed(int iterations) {
+
+    std::vector<SetupPosition>                      setups = speedtest_positions();
+    std::vector<std::vector<Move>>                  pseudoLegal;
+    std::vector<std::vector<std::pair<Move, bool>>> legal;  // With gives_check()
+
+    for (SetupPosition& s : setups)
+    {
+        auto& pl = pseudoLegal.emplace_back();
+        if (s.pos->checkers())
+            for (Move m : MoveList<EVASIONS>(*s.pos))
+                pl.push_back(m);
+        else
+            for (Move m : MoveList<NON_EVASIONS>(*s.pos))
+                pl.push_back(m);
+
+        auto& l = legal.emplace_back();
+        for (Move m : MoveList<LEGAL>(*s.pos))
+            l.emplace_back(m, s.pos->gives_check(m));
+    }
+
+    std::vector<PrimitiveStats> stats;
+
+    // Setting up the positions from FENs and from their packed encoding
+    std::vector<std::string>    fens;
+    std::vector<PackedPosition> packed;
+
+    for (SetupPosition& s : setups)
+    {
+        fens.push_back(s.pos->fen());
+        packed.push_back(s.pos->pack());
+    }
+
+    time_primitive(stats, "set(fen)", iterations, [&](std::uint64_t& results) {
+        StateInfo st;
+        Position  pos;
+        for (const std::string& fen : fens)
+            results += popcount(pos.set(fen, false, &st).pieces());
+        return fens.size();
+    });
+
+    time_primitive(stats, "set(packed)", iterations, [&](std::uint64_t& results) {
+        StateInfo st;
+        Position  pos;
+        for (const PackedPosition& pp : packed)
+            results += popcount(pos.set(pp, false, &st).pieces());
+        return packed.size();
+    });
+
+    time_primitive(stats, "generate<LEGAL>", iterations, [&](std::uint64_t& results) {
+        for (SetupPosition& s : setups)
+            results += MoveList<LEGAL>(*s.pos).size();
+        return setups.size();
+    });
+
+    time_primitive(stats, "generate<CAPTURES>", iterations, [&](std::uint64_t& results) {
+        std::uint64_t ops = 0;
+        for (SetupPosition& s : setups)
+            if (!s.pos->checkers())
+                results += MoveList<CAPTURES>(*s.pos).size(), ops++;
+        return ops;
+    });
+
+    time_primitive(stats, "generate<QUIETS>", iterations, [&](std::uint64_t& results) {
+        std::uint64_t ops = 0;
+        for (SetupPosition& s : setups)
+            if (!s.pos->checkers())
+                results += MoveList<QUIETS>(*s.pos).size(), ops++;
+        return ops;
+    });
+
+    time_primitive(stats, "legal", iterations, [&](std::uint64_t& results) {
+        std::uint64_t ops = 0;
+        for (std::size_t i = 0; i < setups.size(); ++i)
+            for (Move m : pseudoLegal[i])
+                results += setups[i].pos->legal(m), ops++;
+        return ops;
+    });
+
+    time_primitive(stats, "gives_check", iterations, [&](std::uint64_t& results) {
+        std::uint64_t ops = 0;
+        for (std::size_t i = 0; i < setups.size(); ++i)
+            for (auto [m, givesCheck] : legal[i])
+                results += setups[i].pos->gives_check(m), ops++;
+        return ops;
+    });
+
+    time_primitive(stats, "see_ge", iterations, [&](std::uint64_t& results) {
+        std::uint64_t ops = 0;
+        for (std::size_t i = 0; i < setups.size(); ++i)
+            for (auto [m, givesCheck] : legal[i])
+                results += setups[i].pos->see_ge(m), ops++;
+        return ops;
+    });
+
+    // do_move() followed by undo_move(), without and with the bookkeeping of
+    // the threat features that changed, as done for the NNUE
+    for (bool updateThreats : {false, true})
+        time_primitive(stats, updateThreats ? "do/undo_move+threats" : "do/undo_move", iterations,
+                       [&](std::uint64_t& results) {
+                           std::uint64_t ops = 0;
+                           StateInfo     st;
+                           DirtyPiece    dp;
+                           DirtyThreats  dts;
+
+                           for (std::size_t i = 0; i < setups.size(); ++i)
+                               for (auto [m, givesCheck] : legal[i])
+                               {
+                                   Position& pos = *setups[i].pos;
+                                   new (&dts) DirtyThreats;
+                                   pos.do_move(m, st, givesCheck, dp, dts, nullptr, nullptr,
+                                               updateThreats);
+                                   results += dts.list.size();
+                                   pos.undo_move(m);
+                                   ops++;
+                               }
+                           return ops;
+                       });
+
+    return stats;
+}
+
 }  // namespace Stockfish
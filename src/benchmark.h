@@ -19,13 +19,21 @@
 #ifndef BENCHMARK_H_INCLUDED
 #define BENCHMARK_H_INCLUDED
 
+#include <cstdint>
 #include <iosfwd>
 #include <string>
 #include <vector>
 
+namespace Stockfish {
+struct PackedPosition;
+}
+
 namespace Stockfish::Benchmark {
 
-std::vector<std::string> setup_bench(const std::string&, std::istream&);
+std::vector<std::string>
+setup_bench(const std::string&, std::istream&, std::vector<PackedPosition>& packed);
+std::int64_t
+pack_positions(const std::string& fenFile, const std::string& packedFile, bool chess960);
 
 struct BenchmarkSetup {
     int                      ttSize;
@@ -37,6 +45,23 @@ struct BenchmarkSetup {
 
 BenchmarkSetup setup_benchmark(std::istream&);
 
+struct MovePickStats {
+    std::uint64_t positions = 0;
+    std::uint64_t moves     = 0;
+    std::int64_t  elapsed   = 0;  // Microseconds
+};
+
+MovePickStats movepick_speed(int iterations);
+
+struct PrimitiveStats {
+    std::string   name;
+    std::uint64_t ops;
+    std::uint64_t results;  // Sum of the results, such as moves generated
+    std::int64_t  elapsed;  // Nanoseconds
+};
+
+std::vector<PrimitiveStats> position_speed(int iterations);
+
 }  // namespace Stockfish
 
 #endif  // #ifndef BENCHMARK_H_INCLUDED
@@ -19,30 +19,204 @@
 #include "bitboard.h"
 
 #include <algorithm>
-#include <bitset>
+#include <array>
 #include <initializer_list>
 
 #include "misc.h"
 
 namespace Stockfish {
 
-uint8_t PopCnt16[1 << 16];
-uint8_t SquareDistance[SQUARE_NB][SQUARE_NB];
+#ifndef USE_POPCNT
+constexpr std::array<uint8_t, 1 << 16> PopCnt16 = []() {
+    std::array<uint8_t, 1 << 16> popCnt{};
 
-Bitboard LineBB[SQUARE_NB][SQUARE_NB];
-Bitboard BetweenBB[SQUARE_NB][SQUARE_NB];
-Bitboard RayPassBB[SQUARE_NB][SQUARE_NB];
+    for (unsigned i = 1; i < (1 << 16); ++i)
+        popCnt[i] = uint8_t(popCnt[i >> 1] + (i & 1));
 
-alignas(64) Magic Magics[SQUARE_NB][2];
+    return popCnt;
+}();
+#endif
+
+constexpr SquareTable<uint8_t> SquareDistance = []() {
+    SquareTable<uint8_t> dist{};
+
+    for (Square s1 = SQ_A1; s1 <= SQ_H8; ++s1)
+        for (Square s2 = SQ_A1; s2 <= SQ_H8; ++s2)
+        {
+            int df = file_of(s1) - file_of(s2), dr = rank_of(s1) - rank_of(s2);
+            dist[s1][s2] = uint8_t(std::max(df < 0 ? -df : df, dr < 0 ? -dr : dr));
+        }
+
+    return dist;
+}();
+
+// The line tables below only call sliding_attack() for pairs of squares that
+// share a line, which keeps them well within the compilers' constexpr limits.
+constexpr SquareTable<Bitboard> LineBB = []() {
+    SquareTable<Bitboard> line{};
+
+    for (Square s1 = SQ_A1; s1 <= SQ_H8; ++s1)
+        for (PieceType pt : {BISHOP, ROOK})
+            for (Square s2 = SQ_A1; s2 <= SQ_H8; ++s2)
+                if (PseudoAttacks[pt][s1] & s2)
+                    line[s1][s2] = (PseudoAttacks[pt][s1] & PseudoAttacks[pt][s2]) | s1 | s2;
+
+    return line;
+}();
+
+constexpr SquareTable<Bitboard> BetweenBB = []() {
+    SquareTable<Bitboard> between{};
+
+    for (Square s1 = SQ_A1; s1 <= SQ_H8; ++s1)
+        for (PieceType pt : {BISHOP, ROOK})
+            for (Square s2 = SQ_A1; s2 <= SQ_H8; ++s2)
+            {
+                if (PseudoAttacks[pt][s1] & s2)
+                    between[s1][s2] = Bitboards::sliding_attack(pt, s1, square_bb(s2))
+                                    & Bitboards::sliding_attack(pt, s2, square_bb(s1));
+                between[s1][s2] |= s2;
+            }
+
+    return between;
+}();
+
+constexpr SquareTable<Bitboard> RayPassBB = []() {
+    SquareTable<Bitboard> rayPass{};
+
+    for (Square s1 = SQ_A1; s1 <= SQ_H8; ++s1)
+        for (PieceType pt : {BISHOP, ROOK})
+            for (Square s2 = SQ_A1; s2 <= SQ_H8; ++s2)
+                if (PseudoAttacks[pt][s1] & s2)
+                    rayPass[s1][s2] = PseudoAttacks[pt][s1]
+                                    & (Bitboards::sliding_attack(pt, s2, square_bb(s1)) | s2);
+
+    return rayPass;
+}();
+
+#ifdef CONSTEXPR_MAGICS
+
+namespace {
+
+    #if !defined(USE_PEXT) && !defined(IS_64BIT)
+        #error "Compile-time magics need either pext or a 64-bit build"
+    #endif
+
+    #ifndef USE_PEXT
+// Magic numbers printed by init_magics() in 64-bit builds, indexed by
+// [pt - BISHOP][square]. Its PRNG is seeded by rank, so neighbouring squares
+// sometimes find the same magic. Any set of valid magics works here.
+constexpr Bitboard MagicNumbers[2][SQUARE_NB] = {
+  {
+    0x40106000a1160020ULL, 0x0020010250810120ULL, 0x2010010220280081ULL, 0x002806004050c040ULL,
+    0x0002021018000000ULL, 0x2001112010000400ULL, 0x0881010120218080ULL, 0x1030820110010500ULL,
+    0x0000120222042400ULL, 0x2000020404040044ULL, 0x8000480094208000ULL, 0x0003422a02000001ULL,
+    0x000a220210100040ULL, 0x8004820202226000ULL, 0x0018234854100800ULL, 0x0100004042101040ULL,
+    0x0004001004082820ULL, 0x0010000810010048ULL, 0x1014004208081300ULL, 0x2080818802044202ULL,
+    0x0040880c00a00100ULL, 0x0080400200522010ULL, 0x0001000188180b04ULL, 0x0080249202020204ULL,
+    0x1004400004100410ULL, 0x00013100a0022206ULL, 0x2148500001040080ULL, 0x4241080011004300ULL,
+    0x4020848004002000ULL, 0x10101380d1004100ULL, 0x0008004422020284ULL, 0x01010a1041008080ULL,
+    0x0808080400082121ULL, 0x0808080400082121ULL, 0x0091128200100c00ULL, 0x0202200802010104ULL,
+    0x8c0a020200440085ULL, 0x01a0008080b10040ULL, 0x0889520080122800ULL, 0x100902022202010aULL,
+    0x04081a0816002000ULL, 0x0000681208005000ULL, 0x8170840041008802ULL, 0x0a00004200810805ULL,
+    0x0830404408210100ULL, 0x2602208106006102ULL, 0x1048300680802628ULL, 0x2602208106006102ULL,
+    0x0602010120110040ULL, 0x0941010801043000ULL, 0x000040440a210428ULL, 0x0008240020880021ULL,
+    0x0400002012048200ULL, 0x00ac102001210220ULL, 0x0220021002009900ULL, 0x84440c080a013080ULL,
+    0x0001008044200440ULL, 0x0004c04410841000ULL, 0x2000500104011130ULL, 0x1a0c010011c20229ULL,
+    0x0044800112202200ULL, 0x0434804908100424ULL, 0x0300404822c08200ULL, 0x48081010008a2a80ULL},
+  {
+    0x0a80004000801220ULL, 0x8040004010002008ULL, 0x2080200010008008ULL, 0x1100100008210004ULL,
+    0xc200209084020008ULL, 0x2100010004000208ULL, 0x0400081000822421ULL, 0x0200010422048844ULL,
+    0x0800800080400024ULL, 0x0001402000401000ULL, 0x3000801000802001ULL, 0x4400800800100083ULL,
+    0x0904802402480080ULL, 0x4040800400020080ULL, 0x0018808042000100ULL, 0x4040800080004100ULL,
+    0x0040048001458024ULL, 0x00a0004000205000ULL, 0x3100808010002000ULL, 0x4825010010000820ULL,
+    0x5004808008000401ULL, 0x2024818004000a00ULL, 0x0005808002000100ULL, 0x2100060004806104ULL,
+    0x0080400880008421ULL, 0x4062220600410280ULL, 0x010a004a00108022ULL, 0x0000100080080080ULL,
+    0x0021000500080010ULL, 0x0044000202001008ULL, 0x0000100400080102ULL, 0xc020128200040545ULL,
+    0x0080002000400040ULL, 0x0000804000802004ULL, 0x0000120022004080ULL, 0x010a386103001001ULL,
+    0x9010080080800400ULL, 0x8440020080800400ULL, 0x0004228824001001ULL, 0x000000490a000084ULL,
+    0x0080002000504000ULL, 0x200020005000c000ULL, 0x0012088020420010ULL, 0x0010010080080800ULL,
+    0x0085001008010004ULL, 0x0002000204008080ULL, 0x0040413002040008ULL, 0x0000304081020004ULL,
+    0x0080204000800080ULL, 0x3008804000290100ULL, 0x1010100080200080ULL, 0x2008100208028080ULL,
+    0x5000850800910100ULL, 0x8402019004680200ULL, 0x0120911028020400ULL, 0x0000008044010200ULL,
+    0x0020850200244012ULL, 0x0020850200244012ULL, 0x0000102001040841ULL, 0x140900040a100021ULL,
+    0x000200282410a102ULL, 0x000200282410a102ULL, 0x000200282410a102ULL, 0x4048240043802106ULL}};
+    #endif
+
+// Board edges are not considered in the relevant occupancies
+constexpr Bitboard relevant_mask(PieceType pt, Square s) {
+    Bitboard edges = ((Rank1BB | Rank8BB) & ~rank_bb(s)) | ((FileABB | FileHBB) & ~file_bb(s));
+    return Bitboards::sliding_attack(pt, s, 0) & ~edges;
+}
+
+// Fills the sliding attacks of every square in the layout init_magics() would
+// produce. With pext the index of a subset equals its carry-rippler order.
+template<std::size_t Size>
+constexpr std::array<Bitboard, Size> make_attack_table(PieceType pt) {
+    std::array<Bitboard, Size> table{};
+    std::size_t                offset = 0;
+
+    for (Square s = SQ_A1; s <= SQ_H8; ++s)
+    {
+        Bitboard    mask = relevant_mask(pt, s);
+        std::size_t size = 0;
+        Bitboard    b    = 0;
+        do
+        {
+    #ifdef USE_PEXT
+            std::size_t idx = size;
+    #else
+            std::size_t idx = (b * MagicNumbers[pt - BISHOP][s]) >> (64 - constexpr_popcount(mask));
+    #endif
+            table[offset + idx] = Bitboards::sliding_attack(pt, s, b);
+            size++;
+            b = (b - mask) & mask;
+        } while (b);
+
+        offset += size;
+    }
+
+    return table;
+}
+
+constexpr auto RookTable   = make_attack_table<0x19000>(ROOK);
+constexpr auto BishopTable = make_attack_table<0x1480>(BISHOP);
+
+}
+
+alignas(64) constexpr MagicTable Magics = []() {
+    MagicTable      magics{};
+    const Bitboard* attacks[2] = {BishopTable.data(), RookTable.data()};
+
+    for (Square s = SQ_A1; s <= SQ_H8; ++s)
+        for (PieceType pt : {BISHOP, ROOK})
+        {
+            Magic& m  = magics[s][pt - BISHOP];
+            m.mask    = relevant_mask(pt, s);
+            m.attacks = attacks[pt - BISHOP];
+    #ifndef USE_PEXT
+            m.magic = MagicNumbers[pt - BISHOP][s];
+            m.shift = 64 - constexpr_popcount(m.mask);
+    #endif
+            attacks[pt - BISHOP] += 1ULL << constexpr_popcount(m.mask);
+        }
+
+    return magics;
+}();
+
+#else
+
+alignas(64) MagicTable Magics;
 
 namespace {
 
 Bitboard RookTable[0x19000];   // To store rook attacks
 Bitboard BishopTable[0x1480];  // To store bishop attacks
 
-void init_magics(PieceType pt, Bitboard table[], Magic magics[][2]);
+void init_magics(PieceType pt, Bitboard table[], MagicTable& magics);
 }
 
+#endif
+
 // Returns an ASCII representation of a bitboard suitable
 // to be printed to standard output. Useful for debugging.
 std::string Bitboards::pretty(Bitboard b) {
@@ -65,44 +239,24 @@ std::string Bitboards::pretty(Bitboard b) {
 }
 
 
-// Initializes various bitboard tables. It is called at
-// startup and relies on global objects to be already zero-initialized.
+// Initializes the magic bitboards at startup, unless they were generated
+// at compile time. It relies on global objects to be already zero-initialized.
 void Bitboards::init() {
 
-    for (unsigned i = 0; i < (1 << 16); ++i)
-        PopCnt16[i] = uint8_t(std::bitset<16>(i).count());
-
-    for (Square s1 = SQ_A1; s1 <= SQ_H8; ++s1)
-        for (Square s2 = SQ_A1; s2 <= SQ_H8; ++s2)
-            SquareDistance[s1][s2] = std::max(distance<File>(s1, s2), distance<Rank>(s1, s2));
-
+#ifndef CONSTEXPR_MAGICS
     init_magics(ROOK, RookTable, Magics);
     init_magics(BISHOP, BishopTable, Magics);
-
-    for (Square s1 = SQ_A1; s1 <= SQ_H8; ++s1)
-    {
-        for (PieceType pt : {BISHOP, ROOK})
-            for (Square s2 = SQ_A1; s2 <= SQ_H8; ++s2)
-            {
-                if (PseudoAttacks[pt][s1] & s2)
-                {
-                    LineBB[s1][s2] = (attacks_bb(pt, s1, 0) & attacks_bb(pt, s2, 0)) | s1 | s2;
-                    BetweenBB[s1][s2] =
-                      (attacks_bb(pt, s1, square_bb(s2)) & attacks_bb(pt, s2, square_bb(s1)));
-                    RayPassBB[s1][s2] =
-                      attacks_bb(pt, s1, 0) & (attacks_bb(pt, s2, square_bb(s1)) | s2);
-                }
-                BetweenBB[s1][s2] |= s2;
-            }
-    }
+#endif
 }
 
+#ifndef CONSTEXPR_MAGICS
+
 namespace {
 // Computes all rook and bishop attacks at startup. Magic
 // bitboards are used to look up attacks of sliding pieces. As a reference see
 // https://www.chessprogramming.org/Magic_Bitboards. In particular, here we use
 // the so called "fancy" approach.
-void init_magics(PieceType pt, Bitboard table[], Magic magics[][2]) {
+void init_magics(PieceType pt, Bitboard table[], MagicTable& magics) {
 
 #ifndef USE_PEXT
     // Optimal PRNG seeds to pick the correct magics in the shortest time
@@ -132,7 +286,8 @@ void init_magics(PieceType pt, Bitboard table[], Magic magics[][2]) {
 #endif
         // Set the offset for the attacks table of the square. We have individual
         // table sizes for each square with "Fancy Magic Bitboards".
-        m.attacks = s == SQ_A1 ? table : magics[s - 1][pt - BISHOP].attacks + size;
+        table += size;
+        m.attacks = table;
         size      = 0;
 
         // Use Carry-Rippler trick to enumerate all subsets of masks[s] and
@@ -146,7 +301,7 @@ void init_magics(PieceType pt, Bitboard table[], Magic magics[][2]) {
             reference[size] = Bitboards::sliding_attack(pt, s, b);
 
             if (HasPext)
-                m.attacks[pext(b, m.mask)] = reference[size];
+                table[pext(b, m.mask)] = reference[size];
 
             size++;
             b = (b - m.mask) & m.mask;
@@ -174,10 +329,10 @@ void init_magics(PieceType pt, Bitboard table[], Magic magics[][2]) {
 
                 if (epoch[idx] < cnt)
                 {
-                    epoch[idx]     = cnt;
-                    m.attacks[idx] = reference[i];
+                    epoch[idx] = cnt;
+                    table[idx] = reference[i];
                 }
-                else if (m.attacks[idx] != reference[i])
+                else if (table[idx] != reference[i])
                     break;
             }
         }
@@ -186,4 +341,6 @@ void init_magics(PieceType pt, Bitboard table[], Magic magics[][2]) {
 }
 }
 
+#endif
+
 }  // namespace Stockfish
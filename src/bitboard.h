@@ -58,17 +58,23 @@ constexpr Bitboard Rank6BB = Rank1BB << (8 * 5);
 constexpr Bitboard Rank7BB = Rank1BB << (8 * 6);
 constexpr Bitboard Rank8BB = Rank1BB << (8 * 7);
 
-extern uint8_t PopCnt16[1 << 16];
-extern uint8_t SquareDistance[SQUARE_NB][SQUARE_NB];
+template<typename T>
+using SquareTable = std::array<std::array<T, SQUARE_NB>, SQUARE_NB>;
 
-extern Bitboard BetweenBB[SQUARE_NB][SQUARE_NB];
-extern Bitboard LineBB[SQUARE_NB][SQUARE_NB];
-extern Bitboard RayPassBB[SQUARE_NB][SQUARE_NB];
+// These tables are generated at compile time and live in read-only data
+#ifndef USE_POPCNT
+extern const std::array<uint8_t, 1 << 16> PopCnt16;
+#endif
+extern const SquareTable<uint8_t> SquareDistance;
+
+extern const SquareTable<Bitboard> BetweenBB;
+extern const SquareTable<Bitboard> LineBB;
+extern const SquareTable<Bitboard> RayPassBB;
 
 // Magic holds all magic bitboards relevant data for a single square
 struct Magic {
-    Bitboard  mask;
-    Bitboard* attacks;
+    Bitboard        mask;
+    const Bitboard* attacks;
 #ifndef USE_PEXT
     Bitboard magic;
     unsigned shift;
@@ -92,7 +98,13 @@ struct Magic {
     Bitboard attacks_bb(Bitboard occupied) const { return attacks[index(occupied)]; }
 };
 
-extern Magic Magics[SQUARE_NB][2];
+using MagicTable = std::array<std::array<Magic, 2>, SQUARE_NB>;
+
+#ifdef CONSTEXPR_MAGICS
+extern const MagicTable Magics;
+#else
+extern MagicTable Magics;
+#endif
 
 constexpr Bitboard square_bb(Square s) {
     assert(is_ok(s));
@@ -0,0 +1,66 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2026 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOOK_H_INCLUDED
+#define BOOK_H_INCLUDED
+
+#include <cstdint>
+#include <string>
+
+#include "types.h"
+
+namespace Stockfish {
+
+class Position;
+
+namespace Book {
+
+// Opening books use the Polyglot file layout: a sequence of 16-byte entries
+// sorted by key, all integers in big-endian order.
+//
+//   uint64_t  position key
+//   uint16_t  move: to square in bits 0-5, from square in bits 6-11 and the
+//             promotion piece (1 = knight ... 4 = queen) in bits 12-14.
+//             Castling is encoded as the king capturing its own rook.
+//   uint16_t  weight, moves are picked with probability proportional to it
+//   uint32_t  learn, unused
+//
+// Positions are keyed by Book::key(), the standard Polyglot key, so that books
+// made by other tools can be used. It is independent of the Zobrist keys of the
+// search.
+void init(const std::string& path);
+
+// Returns the book key of the position: the xor of one random key per piece
+// on its square, per castling right, for the file of a possible en passant
+// capture and for White to move, from Polyglot's Random64 table.
+Key key(const Position& pos);
+
+// Returns a legal book move for the position, or Move::none() if the position
+// is not in the book.
+Move probe(const Position& pos);
+
+// Writes a book in the above layout from the first plies of self-play games
+// and returns the number of entries written. Each move is weighted by its score from the games where
+// it was played, two points for a win and one for a draw.
+uint64_t make(const std::string& gamesFile, const std::string& bookFile, int plies);
+
+}  // namespace Book
+
+}  // namespace Stockfish
+
+#endif  // #ifndef BOOK_H_INCLUDED
@@ -21,15 +21,19 @@
 #include <algorithm>
 #include <cassert>
 #include <deque>
+#include <fstream>
 #include <iosfwd>
 #include <memory>
 #include <ostream>
 #include <sstream>
+#include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include "book.h"
 #include "evaluate.h"
+#include "learning.h"
 #include "misc.h"
 #include "nnue/network.h"
 #include "nnue/nnue_common.h"
@@ -37,7 +41,9 @@
 #include "numa.h"
 #include "perft.h"
 #include "position.h"
+#include "score.h"
 #include "search.h"
+#include "selfplay.h"
 #include "shm.h"
 #include "syzygy/tbprobe.h"
 #include "types.h"
@@ -129,6 +135,20 @@ Engine::Engine(std::optional<std::string> path) :
           return std::nullopt;
       }));
 
+    options.add("OwnBook", Option(false));
+
+    options.add(  //
+      "BookFile", Option("", [](const Option& o) {
+          Book::init(o);
+          return std::nullopt;
+      }));
+
+    options.add(  //
+      "LearningFile", Option("", [](const Option& o) {
+          Learning::init(o);
+          return std::nullopt;
+      }));
+
     options.add("SyzygyProbeDepth", Option(1, 1, 100));
 
     options.add("Syzygy50MoveRule", Option(true));
@@ -136,14 +156,30 @@ Engine::Engine(std::optional<std::string> path) :
     options.add("SyzygyProbeLimit", Option(7, 0, 7));
 
     options.add(  //
-      "EvalFile", Option(EvalFileDefaultNameBig, [this](const Option& o) {
-          load_big_network(o);
+      "EvalFile", Option(EvalFileDefaultNameBig, [this](const Option&) {
+          load_networks_in_background();
           return std::nullopt;
       }));
 
     options.add(  //
-      "EvalFileSmall", Option(EvalFileDefaultNameSmall, [this](const Option& o) {
-          load_small_network(o);
+      "EvalFileSmall", Option(EvalFileDefaultNameSmall, [this](const Option&) {
+          load_networks_in_background();
+          return std::nullopt;
+      }));
+
+    options.add(  //
+      "SmallNetOnly", Option(false, [this](const Option&) {
+          threads.clear_accumulator_caches();  // Cached evals depend on the mode
+          return std::nullopt;
+      }));
+
+    options.add("EvalCache", Option(false));
+
+    options.add("SpeculativeEval", Option(false));
+
+    options.add(  //
+      "ThreatOrderFile", Option("", [this](const Option& o) {
+          set_threat_row_order(o);
           return std::nullopt;
       }));
 
@@ -159,10 +195,52 @@ std::uint64_t Engine::perft(const std::string& fen, Depth depth, bool isChess960
 
 void Engine::go(Search::LimitsType& limits) {
     assert(limits.perft == 0);
+    wait_for_search_finished();
+    install_loaded_networks();
     verify_networks();
 
+    // Learned positions seed the TT, and a depth limited search is answered at
+    // once when the stored result is already at least as deep. The answer goes
+    // through a depth 1 search restricted to the stored move, so the stored
+    // depth and score are reported first, the info of that search is not them.
+    if (const auto e = Learning::seed(pos, tt))
+        if (limits.depth && e->depth >= limits.depth && e->bound == BOUND_EXACT
+            && limits.searchmoves.empty() && !limits.infinite)
+        {
+            const std::string move = UCIEngine::move(Move(e->move), pos.is_chess960());
+
+            sync_cout << "info string Learned move " << move << " depth " << int(e->depth)
+                      << " score " << UCIEngine::format_score(Score(Value(e->score), pos))
+                      << sync_endl;
+
+            limits.searchmoves = {move};
+            limits.depth       = 1;
+        }
+
     threads.start_thinking(options, pos, states, limits);
 }
+
+void Engine::analyse(const std::vector<Search::AnalysisPosition>&    positions,
+                     const Search::LimitsType&                       limits,
+                     const std::function<void(const InfoAnalysis&)>& onResult) {
+    wait_for_search_finished();
+    install_loaded_networks();
+    verify_networks();
+
+    tt.new_search();
+    threads.analyse(positions, limits, onResult);
+}
+
+SelfPlay::Stats Engine::self_play(const SelfPlay::Config&                            config,
+                                  const std::function<void(const SelfPlay::Stats&)>& onProgress) {
+    search_clear();
+    install_loaded_networks();
+    verify_networks();
+
+    tt.new_search();
+    return SelfPlay::generate(threads, config, onProgress);
+}
+
 void Engine::stop() { threads.stop = true; }
 
 void Engine::search_clear() {
@@ -201,7 +279,16 @@ void Engine::set_position(const std::string& fen, const std::vector<std::string>
     // Drop the old state and create a new one
     states = StateListPtr(new std::deque<StateInfo>(1));
     pos.set(fen, options["UCI_Chess960"], &states->back());
+    play_moves(moves);
+}
+
+void Engine::set_position(const PackedPosition& pp, const std::vector<std::string>& moves) {
+    states = StateListPtr(new std::deque<StateInfo>(1));
+    pos.set(pp, options["UCI_Chess960"], &states->back());
+    play_moves(moves);
+}
 
+void Engine::play_moves(const std::vector<std::string>& moves) {
     for (const auto& move : moves)
     {
         auto m = UCIEngine::to_move(pos, move);
@@ -217,6 +304,9 @@ void Engine::set_position(const std::string& fen, const std::vector<std::string>
 // modifiers
 
 void Engine::set_numa_config_from_option(const std::string& o) {
+    // The background loader attaches the networks it replicates to the context
+    wait_for_networks_loaded();
+
     if (o == "auto" || o == "system")
     {
         numaContext.set_numa_config(NumaConfig::from_system(DefaultNumaPolicy));
@@ -260,8 +350,8 @@ void Engine::set_ponderhit(bool b) { threads.main_manager()->ponder = b; }
 // network related
 
 void Engine::verify_networks() const {
-    networks->big.verify(options["EvalFile"], onVerifyNetworks);
-    networks->small.verify(options["EvalFileSmall"], onVerifyNetworks);
+    networks->big.verify(installedEvalFiles[0], onVerifyNetworks);
+    networks->small.verify(installedEvalFiles[1], onVerifyNetworks);
 
     auto statuses = networks.get_status_and_errors();
     for (size_t i = 0; i < statuses.size(); ++i)
@@ -295,29 +385,103 @@ void Engine::verify_networks() const {
 }
 
 void Engine::load_networks() {
+    wait_for_networks_loaded();
+    loadedNetworks.reset();
+    networksLoaded = false;
+
+    installedEvalFiles = {options["EvalFile"], options["EvalFileSmall"]};
+
     networks.modify_and_replicate([this](NN::Networks& networks_) {
-        networks_.big.load(binaryDirectory, options["EvalFile"]);
-        networks_.small.load(binaryDirectory, options["EvalFileSmall"]);
+        networks_.big.load(binaryDirectory, installedEvalFiles[0]);
+        networks_.small.load(binaryDirectory, installedEvalFiles[1]);
     });
     threads.clear();
     threads.ensure_network_replicated();
 }
 
-void Engine::load_big_network(const std::string& file) {
-    networks.modify_and_replicate(
-      [this, &file](NN::Networks& networks_) { networks_.big.load(binaryDirectory, file); });
-    threads.clear();
+// Loading and replicating the networks may take seconds, which a running
+// server cannot afford to spend between searches. They are prepared on
+// another thread while searches go on with the current networks, starting
+// from the most recent networks so that only the changed file is read.
+void Engine::load_networks_in_background() {
+    wait_for_networks_loaded();
+
+    auto source = std::make_unique<NN::Networks>(loadedNetworks ? **loadedNetworks : *networks);
+
+    loadedEvalFiles = {options["EvalFile"], options["EvalFileSmall"]};
+    networksLoaded  = false;
+
+    networkLoader = std::thread([this, source = std::move(source)]() mutable {
+        source->big.load(binaryDirectory, loadedEvalFiles[0]);
+        source->small.load(binaryDirectory, loadedEvalFiles[1]);
+
+        loadedNetworks = std::make_unique<ReplicatedNetworks>(numaContext, std::move(source));
+        networksLoaded = true;
+    });
+}
+
+void Engine::wait_for_networks_loaded() {
+    if (networkLoader.joinable())
+        networkLoader.join();
+}
+
+// Switches to the networks loaded in the background, if they are ready. This
+// only exchanges pointers, but must happen between searches. Histories are
+// kept, only the accumulator caches derived from the old networks are reset.
+void Engine::install_loaded_networks() {
+    if (!networksLoaded)
+        return;
+
+    wait_for_networks_loaded();
+
+    networks.swap_contents(*loadedNetworks);
+    installedEvalFiles = loadedEvalFiles;
+
+    loadedNetworks.reset();
+    networksLoaded = false;
+
     threads.ensure_network_replicated();
+    threads.clear_accumulator_caches();
 }
 
-void Engine::load_small_network(const std::string& file) {
-    networks.modify_and_replicate(
-      [this, &file](NN::Networks& networks_) { networks_.small.load(binaryDirectory, file); });
-    threads.clear();
+void Engine::set_threat_row_order(const std::string& histogramFile) {
+    std::vector<std::uint64_t> hits;
+
+    if (!histogramFile.empty() && histogramFile != "<empty>")
+    {
+        std::ifstream in(histogramFile);
+        std::uint64_t count;
+
+        while (in >> count)
+            hits.push_back(count);
+
+        if (hits.size() != NN::Features::FullThreats::Dimensions)
+        {
+            sync_cout << "info string Invalid threat histogram " << histogramFile << sync_endl;
+            return;
+        }
+    }
+
+    // Loaded networks are stored in the order of the time they were loaded,
+    // so the order can only change together with theirs, between searches.
+    wait_for_search_finished();
+    wait_for_networks_loaded();
+    install_loaded_networks();
+
+    NN::Features::FullThreats::set_row_order(hits);
+
+    networks.modify_and_replicate([](NN::Networks& networks_) {
+        networks_.big.apply_threat_row_order();
+        networks_.small.apply_threat_row_order();
+    });
     threads.ensure_network_replicated();
 }
 
 void Engine::save_network(const std::pair<std::optional<std::string>, std::string> files[2]) {
+    wait_for_search_finished();
+    wait_for_networks_loaded();
+    install_loaded_networks();
+
     networks.modify_and_replicate([&files](NN::Networks& networks_) {
         networks_.big.save(files[0].first);
         networks_.small.save(files[1].first);
@@ -326,11 +490,12 @@ void Engine::save_network(const std::pair<std::optional<std::string>, std::strin
 
 // utility functions
 
-void Engine::trace_eval() const {
+void Engine::trace_eval() {
     StateListPtr trace_states(new std::deque<StateInfo>(1));
     Position     p;
     p.set(pos.fen(), options["UCI_Chess960"], &trace_states->back());
 
+    install_loaded_networks();
     verify_networks();
 
     sync_cout << "\n" << Eval::trace(p, *networks) << sync_endl;
@@ -351,6 +516,16 @@ std::string Engine::visualize() const {
 
 int Engine::get_hashfull(int maxAge) const { return tt.hashfull(maxAge); }
 
+std::size_t Engine::get_accumulator_stack_size() const { return threads.accumulator_stack_size(); }
+
+std::pair<std::uint64_t, std::uint64_t> Engine::get_eval_cache_stats() const {
+    return threads.eval_cache_stats();
+}
+
+std::pair<std::uint64_t, std::uint64_t> Engine::get_reeval_stats() const {
+    return threads.reeval_stats();
+}
+
 std::vector<std::pair<size_t, size_t>> Engine::get_bound_thread_count_by_numa_node() const {
     auto                                   counts = threads.get_bound_thread_count_by_numa_node();
     const NumaConfig&                      cfg    = numaContext.get_numa_config();
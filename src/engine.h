@@ -19,13 +19,17 @@
 #ifndef ENGINE_H_INCLUDED
 #define ENGINE_H_INCLUDED
 
+#include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <map>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -34,6 +38,7 @@
 #include "numa.h"
 #include "position.h"
 #include "search.h"
+#include "selfplay.h"
 #include "syzygy/tbprobe.h"  // for Stockfish::Depth
 #include "thread.h"
 #include "tt.h"
@@ -43,9 +48,10 @@ namespace Stockfish {
 
 class Engine {
    public:
-    using InfoShort = Search::InfoShort;
-    using InfoFull  = Search::InfoFull;
-    using InfoIter  = Search::InfoIteration;
+    using InfoShort    = Search::InfoShort;
+    using InfoFull     = Search::InfoFull;
+    using InfoIter     = Search::InfoIteration;
+    using InfoAnalysis = Search::InfoAnalysis;
 
     Engine(std::optional<std::string> path = std::nullopt);
 
@@ -55,12 +61,22 @@ class Engine {
     Engine& operator=(const Engine&) = delete;
     Engine& operator=(Engine&&)      = delete;
 
-    ~Engine() { wait_for_search_finished(); }
+    ~Engine() {
+        wait_for_search_finished();
+        wait_for_networks_loaded();
+    }
 
     std::uint64_t perft(const std::string& fen, Depth depth, bool isChess960);
 
     // non blocking call to start searching
     void go(Search::LimitsType&);
+    // blocking call to search many positions concurrently, one per thread
+    void analyse(const std::vector<Search::AnalysisPosition>& positions,
+                 const Search::LimitsType&                    limits,
+                 const std::function<void(const InfoAnalysis&)>& onResult);
+    // blocking call to play self-play games and write them as training data
+    SelfPlay::Stats self_play(const SelfPlay::Config&                            config,
+                              const std::function<void(const SelfPlay::Stats&)>& onProgress);
     // non blocking call to stop searching
     void stop();
 
@@ -68,6 +84,7 @@ class Engine {
     void wait_for_search_finished();
     // set a new position, moves are in UCI format
     void set_position(const std::string& fen, const std::vector<std::string>& moves);
+    void set_position(const PackedPosition& pp, const std::vector<std::string>& moves);
 
     // modifiers
 
@@ -87,18 +104,28 @@ class Engine {
 
     void verify_networks() const;
     void load_networks();
-    void load_big_network(const std::string& file);
-    void load_small_network(const std::string& file);
+    // non blocking call to load the networks of the EvalFile options, which
+    // replace the current ones at the start of the first search after loading
+    void load_networks_in_background();
+    // blocking call to wait for a background load to finish
+    void wait_for_networks_loaded();
+    void install_loaded_networks();
+    // store the threat weights in order of use, given by a histogram recorded
+    // with the threathist command
+    void set_threat_row_order(const std::string& histogramFile);
     void save_network(const std::pair<std::optional<std::string>, std::string> files[2]);
 
     // utility functions
 
-    void trace_eval() const;
+    void trace_eval();
 
     const OptionsMap& get_options() const;
     OptionsMap&       get_options();
 
-    int get_hashfull(int maxAge = 0) const;
+    int                                     get_hashfull(int maxAge = 0) const;
+    std::size_t                             get_accumulator_stack_size() const;
+    std::pair<std::uint64_t, std::uint64_t> get_eval_cache_stats() const;
+    std::pair<std::uint64_t, std::uint64_t> get_reeval_stats() const;
 
     std::string                            fen() const;
     void                                   flip();
@@ -110,6 +137,8 @@ class Engine {
     std::string                            thread_binding_information_as_string() const;
 
    private:
+    void play_moves(const std::vector<std::string>& moves);
+
     const std::string binaryDirectory;
 
     NumaReplicationContext numaContext;
@@ -117,10 +146,20 @@ class Engine {
     Position     pos;
     StateListPtr states;
 
-    OptionsMap                                         options;
-    ThreadPool                                         threads;
-    TranspositionTable                                 tt;
-    LazyNumaReplicatedSystemWide<Eval::NNUE::Networks> networks;
+    using ReplicatedNetworks = LazyNumaReplicatedSystemWide<Eval::NNUE::Networks>;
+
+    OptionsMap         options;
+    ThreadPool         threads;
+    TranspositionTable tt;
+    ReplicatedNetworks networks;
+
+    // Networks being loaded and replicated by networkLoader, and the files
+    // they come from. The files of the installed networks are kept apart from
+    // the options, which may already name networks still being loaded.
+    std::thread                         networkLoader;
+    std::atomic<bool>                   networksLoaded = false;
+    std::unique_ptr<ReplicatedNetworks> loadedNetworks;
+    std::array<std::string, 2>          loadedEvalFiles, installedEvalFiles;
 
     Search::SearchManager::UpdateContext  updateContext;
     std::function<void(std::string_view)> onVerifyNetworks;
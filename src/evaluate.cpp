@@ -54,22 +54,58 @@ Value Eval::evaluate(const Eval::NNUE::Networks&    networks,
                      const Position&                pos,
                      Eval::NNUE::AccumulatorStack&  accumulators,
                      Eval::NNUE::AccumulatorCaches& caches,
+                     EvalCache*                     evalCache,
+                     ReevalStats&                   reevalStats,
+                     bool                           smallNetOnly,
+                     bool                           speculativeEval,
                      int                            optimism) {
 
     assert(!pos.checkers());
 
-    bool smallNet           = use_smallnet(pos);
-    auto [psqt, positional] = smallNet ? networks.small.evaluate(pos, accumulators, caches.small)
-                                       : networks.big.evaluate(pos, accumulators, caches.big);
+    Value             psqt, positional, nnue;
+    EvalCache::Entry* entry = nullptr;
 
-    Value nnue = (125 * psqt + 131 * positional) / 128;
+    if (evalCache)
+    {
+        entry = &(*evalCache)[pos.key()];
+        evalCache->probes++;
+    }
 
-    // Re-evaluate the position when higher eval accuracy is worth the time spent
-    if (smallNet && (std::abs(nnue) < 277))
+    if (entry && entry->key == pos.key())
     {
-        std::tie(psqt, positional) = networks.big.evaluate(pos, accumulators, caches.big);
-        nnue                       = (125 * psqt + 131 * positional) / 128;
-        smallNet                   = false;
+        evalCache->hits++;
+        psqt       = entry->psqt;
+        positional = entry->positional;
+        nnue       = (125 * psqt + 131 * positional) / 128;
+    }
+    else
+    {
+        bool smallNet = smallNetOnly || use_smallnet(pos);
+
+        // With speculative evaluation the big net accumulators are caught up
+        // together with the small net one, so that a re-evaluation only costs
+        // the big net propagation.
+        if (smallNet && !smallNetOnly && speculativeEval)
+            networks.update_accumulators(pos, accumulators, caches);
+
+        std::tie(psqt, positional) = smallNet
+                                     ? networks.small.evaluate(pos, accumulators, caches.small)
+                                     : networks.big.evaluate(pos, accumulators, caches.big);
+
+        nnue = (125 * psqt + 131 * positional) / 128;
+
+        // Re-evaluate the position when higher eval accuracy is worth the time spent
+        reevalStats.smallNetEvals += smallNet;
+
+        if (smallNet && !smallNetOnly && (std::abs(nnue) < 277))
+        {
+            reevalStats.bigNetReevals++;
+            std::tie(psqt, positional) = networks.big.evaluate(pos, accumulators, caches.big);
+            nnue                       = (125 * psqt + 131 * positional) / 128;
+        }
+
+        if (entry)
+            *entry = {pos.key(), psqt, positional};
     }
 
     // Blend optimism and eval with nnue complexity
@@ -98,8 +134,9 @@ std::string Eval::trace(Position& pos, const Eval::NNUE::Networks& networks) {
     if (pos.checkers())
         return "Final evaluation: none (in check)";
 
-    auto accumulators = std::make_unique<Eval::NNUE::AccumulatorStack>();
-    auto caches       = std::make_unique<Eval::NNUE::AccumulatorCaches>(networks);
+    auto        accumulators = std::make_unique<Eval::NNUE::AccumulatorStack>();
+    auto        caches       = std::make_unique<Eval::NNUE::AccumulatorCaches>(networks);
+    ReevalStats reevalStats;
 
     std::stringstream ss;
     ss << std::showpoint << std::noshowpos << std::fixed << std::setprecision(2);
@@ -112,7 +149,8 @@ std::string Eval::trace(Position& pos, const Eval::NNUE::Networks& networks) {
     v                       = pos.side_to_move() == WHITE ? v : -v;
     ss << "NNUE evaluation        " << 0.01 * UCIEngine::to_cp(v, pos) << " (white side)\n";
 
-    v = evaluate(networks, pos, *accumulators, *caches, VALUE_ZERO);
+    v = evaluate(networks, pos, *accumulators, *caches, nullptr, reevalStats, false, false,
+                 VALUE_ZERO);
     v = pos.side_to_move() == WHITE ? v : -v;
     ss << "Final evaluation       " << 0.01 * UCIEngine::to_cp(v, pos) << " (white side)";
     ss << " [with scaled NNUE, ...]";
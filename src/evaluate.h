@@ -19,6 +19,9 @@
 #ifndef EVALUATE_H_INCLUDED
 #define EVALUATE_H_INCLUDED
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 #include "types.h"
@@ -42,6 +45,30 @@ struct AccumulatorCaches;
 class AccumulatorStack;
 }
 
+// EvalCache is a small direct-mapped cache of the network outputs, one per
+// thread, used with the EvalCache option. The outputs only depend on the pieces
+// and the side to move, so it also catches repeated positions which are no
+// longer in the TT.
+struct EvalCache {
+    struct Entry {
+        Key          key;
+        std::int32_t psqt, positional;
+    };
+
+    static constexpr std::size_t Size = 4096;
+
+    void   clear() { entries.fill({}); }
+    Entry& operator[](Key key) { return entries[key & (Size - 1)]; }
+
+    std::array<Entry, Size> entries;
+    std::uint64_t           probes = 0, hits = 0;
+};
+
+// Small net evaluations, and how many of them fell back to the big net, per thread
+struct ReevalStats {
+    std::uint64_t smallNetEvals = 0, bigNetReevals = 0;
+};
+
 std::string trace(Position& pos, const Eval::NNUE::Networks& networks);
 
 int   simple_eval(const Position& pos);
@@ -50,6 +77,10 @@ Value evaluate(const NNUE::Networks&          networks,
                const Position&                pos,
                Eval::NNUE::AccumulatorStack&  accumulators,
                Eval::NNUE::AccumulatorCaches& caches,
+               EvalCache*                     evalCache,
+               ReevalStats&                   reevalStats,
+               bool                           smallNetOnly,
+               bool                           speculativeEval,
                int                            optimism);
 }  // namespace Eval
 
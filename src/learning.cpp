@@ -0,0 +1,182 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2026 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "learning.h"
+
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+
+#include "memory.h"
+#include "misc.h"
+#include "position.h"
+#include "search.h"
+#include "tt.h"
+
+namespace Stockfish::Learning {
+
+namespace {
+
+// PV positions searched shallower than this are not worth storing
+constexpr Depth MinDepth = 8;
+
+// Entries of the file are used in place from the mapping, while those
+// recorded since it was mapped live in 'appended'. The index points to the
+// deepest entry of each key in either of them. The mutex serializes the
+// option callback, seeding by the UCI thread and recording by the main thread.
+std::mutex                            mutex;
+const Entry*                          mapped = nullptr;
+uint64_t                              mapping;
+std::deque<Entry>                     appended;
+std::unordered_map<Key, const Entry*> index;
+std::ofstream                         out;
+
+void add_to_index(const Entry* e) {
+    const Entry*& deepest = index[e->key];
+    if (!deepest || deepest->depth <= e->depth)
+        deepest = e;
+}
+
+}  // namespace
+
+void init(const std::string& path) {
+
+    std::lock_guard<std::mutex> lk(mutex);
+
+    index.clear();
+    appended.clear();
+    out.close();
+
+    if (mapped)
+        unmap_file(mapped, mapping);
+
+    mapped = nullptr;
+
+    if (path.empty() || path == "<empty>")
+        return;
+
+    size_t size = 0;
+    mapped      = static_cast<const Entry*>(map_file(path, &size, &mapping));
+
+    // A partial entry is left by an interrupted write, appending after it
+    // would misalign every later entry.
+    if (size % sizeof(Entry))
+    {
+        unmap_file(mapped, mapping);
+        mapped = nullptr;
+        sync_cout << "info string Corrupt learning file " << path << sync_endl;
+        return;
+    }
+
+    for (size_t i = 0; i < size / sizeof(Entry); ++i)
+        add_to_index(&mapped[i]);
+
+    out.open(path, std::ios::binary | std::ios::app);
+
+    if (!out)
+        sync_cout << "info string Unable to open file " << path << sync_endl;
+    else
+        sync_cout << "info string Found " << index.size() << " learned positions in " << path
+                  << sync_endl;
+}
+
+std::optional<Entry> seed(const Position& pos, TranspositionTable& tt) {
+
+    std::lock_guard<std::mutex> lk(mutex);
+
+    if (index.empty())
+        return std::nullopt;
+
+    StateListPtr states(new std::deque<StateInfo>(1));
+    Position     p;
+    p.set(pos.fen(), pos.is_chess960(), &states->back());
+
+    std::optional<Entry> root;
+
+    for (int ply = 0; ply < MAX_PLY; ++ply)
+    {
+        auto it = index.find(p.state()->key);
+        if (it == index.end())
+            break;
+
+        const Entry* e = it->second;
+        Move         m(e->move);
+
+        // Guard against key collisions before trusting the stored move
+        if (!m.is_ok() || !p.pseudo_legal(m) || !p.legal(m))
+            break;
+
+        if (!ply)
+            root = *e;
+
+        auto [ttHit, ttData, ttWriter] = tt.probe(p.key());
+
+        if (!ttHit || ttData.depth < e->depth)
+            ttWriter.write(p.key(), Value(e->score), true, Bound(e->bound), e->depth, m,
+                           VALUE_NONE, tt.generation());
+
+        states->emplace_back();
+        p.do_move(m, states->back());
+    }
+
+    return root;
+}
+
+void record(const Position& pos, const Search::RootMove& rm, Depth depth) {
+
+    std::lock_guard<std::mutex> lk(mutex);
+
+    if (!out.is_open() || depth < 1 || rm.score == -VALUE_INFINITE || rm.scoreLowerbound
+        || rm.scoreUpperbound)
+        return;
+
+    StateListPtr states(new std::deque<StateInfo>(1));
+    Position     p;
+    p.set(pos.fen(), pos.is_chess960(), &states->back());
+
+    Value v = rm.score;
+
+    for (size_t ply = 0; ply < rm.pv.size() && (!ply || depth - int(ply) >= MinDepth); ++ply)
+    {
+        // Mate scores are stored relative to the position, as in the TT
+        Value s = is_win(v) ? v + int(ply) : is_loss(v) ? v - int(ply) : v;
+        Entry e{p.state()->key, rm.pv[ply].raw(), int16_t(s), uint8_t(depth - int(ply)),
+                uint8_t(BOUND_EXACT), 0};
+
+        auto it = index.find(e.key);
+
+        if (it == index.end() || it->second->depth < e.depth)
+        {
+            appended.push_back(e);
+            out.write(reinterpret_cast<const char*>(&appended.back()), sizeof(Entry));
+            add_to_index(&appended.back());
+        }
+
+        states->emplace_back();
+        p.do_move(rm.pv[ply], states->back());
+        v = -v;
+    }
+
+    out.flush();
+}
+
+}  // namespace Stockfish::Learning
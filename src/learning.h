@@ -0,0 +1,70 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2026 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LEARNING_H_INCLUDED
+#define LEARNING_H_INCLUDED
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "types.h"
+
+namespace Stockfish {
+
+class Position;
+class TranspositionTable;
+
+namespace Search {
+struct RootMove;
+}
+
+namespace Learning {
+
+// The learning file is an append-only log of search results for root and PV
+// positions. A position is only appended again when searched deeper, and on
+// loading the deepest record of each key wins.
+struct Entry {
+    Key      key;      // Zobrist key without the rule 50 adjustment
+    uint16_t move;     // Move::raw() of the best move
+    int16_t  score;    // From the side to move's point of view, mates counted from it
+    uint8_t  depth;
+    uint8_t  bound;
+    uint16_t padding;
+};
+
+static_assert(sizeof(Entry) == 16, "Unexpected learning entry size");
+
+// Loads the index of the learning file, which is created if needed. An empty
+// path disables learning.
+void init(const std::string& path);
+
+// Writes the stored results for the position and for the positions along its
+// stored best line into the TT, and returns the entry of the position itself
+// if it has one. Must not run concurrently with a search writing to the TT.
+std::optional<Entry> seed(const Position& pos, TranspositionTable& tt);
+
+// Records the result of a finished search: the root and the positions of its
+// PV that were still searched to a useful depth.
+void record(const Position& pos, const Search::RootMove& rm, Depth depth);
+
+}  // namespace Learning
+
+}  // namespace Stockfish
+
+#endif  // #ifndef LEARNING_H_INCLUDED
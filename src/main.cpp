@@ -31,7 +31,6 @@ int main(int argc, char* argv[]) {
     std::cout << engine_info() << std::endl;
 
     Bitboards::init();
-    Position::init();
 
     auto uci = std::make_unique<UCIEngine>(argc, argv);
 
@@ -24,8 +24,11 @@
     #include <features.h>
 #endif
 
-#if defined(__linux__) && !defined(__ANDROID__)
+#ifndef _WIN32
+    #include <fcntl.h>
     #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
 #endif
 
 #if defined(__APPLE__) || defined(__ANDROID__) || defined(__OpenBSD__) \
@@ -196,4 +199,86 @@ void aligned_large_pages_free(void* mem) {
 void aligned_large_pages_free(void* mem) { std_aligned_free(mem); }
 
 #endif
+
+#ifndef _WIN32
+
+const void* map_file(const std::string& path, size_t* size, uint64_t* mapping) {
+
+    struct stat statbuf;
+    int         fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd == -1)
+        return nullptr;
+
+    if (fstat(fd, &statbuf) == -1 || statbuf.st_size == 0)
+    {
+        ::close(fd);
+        return nullptr;
+    }
+
+    void* baseAddress = mmap(nullptr, statbuf.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (baseAddress == MAP_FAILED)
+        return nullptr;
+
+    #if defined(MADV_RANDOM)
+    madvise(baseAddress, statbuf.st_size, MADV_RANDOM);
+    #endif
+
+    *size    = size_t(statbuf.st_size);
+    *mapping = uint64_t(statbuf.st_size);
+    return baseAddress;
+}
+
+void unmap_file(const void* baseAddress, uint64_t mapping) {
+    munmap(const_cast<void*>(baseAddress), mapping);
+}
+
+#else
+
+const void* map_file(const std::string& path, size_t* size, uint64_t* mapping) {
+
+    // Note FILE_FLAG_RANDOM_ACCESS is only a hint to Windows and as such may get ignored.
+    HANDLE fd = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_FLAG_RANDOM_ACCESS, nullptr);
+
+    if (fd == INVALID_HANDLE_VALUE)
+        return nullptr;
+
+    DWORD size_high;
+    DWORD size_low = GetFileSize(fd, &size_high);
+
+    if (size_low == 0 && size_high == 0)
+    {
+        CloseHandle(fd);
+        return nullptr;
+    }
+
+    HANDLE mmap = CreateFileMapping(fd, nullptr, PAGE_READONLY, size_high, size_low, nullptr);
+    CloseHandle(fd);
+
+    if (!mmap)
+        return nullptr;
+
+    void* baseAddress = MapViewOfFile(mmap, FILE_MAP_READ, 0, 0, 0);
+
+    if (!baseAddress)
+    {
+        CloseHandle(mmap);
+        return nullptr;
+    }
+
+    *size    = size_t((uint64_t(size_high) << 32) | size_low);
+    *mapping = uint64_t(mmap);
+    return baseAddress;
+}
+
+void unmap_file(const void* baseAddress, uint64_t mapping) {
+    UnmapViewOfFile(baseAddress);
+    CloseHandle((HANDLE) mapping);
+}
+
+#endif
+
 }  // namespace Stockfish
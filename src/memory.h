@@ -24,6 +24,7 @@
 #include <cstdint>
 #include <memory>
 #include <new>
+#include <string>
 #include <type_traits>
 #include <utility>
 
@@ -70,6 +71,12 @@ void  aligned_large_pages_free(void* mem);
 
 bool has_large_pages();
 
+// Maps a whole file read-only, advised for random access. Returns nullptr if
+// the file cannot be opened or is empty, otherwise its size is stored in 'size'
+// and the handle to pass to unmap_file() in 'mapping'.
+const void* map_file(const std::string& path, size_t* size, uint64_t* mapping);
+void        unmap_file(const void* baseAddress, uint64_t mapping);
+
 // Frees memory which was placed there with placement new.
 // Works for both single objects and arrays of unknown bound.
 template<typename T, typename FREE_FUNC>
@@ -270,6 +270,10 @@ std::string compiler_info() {
     compiler += " DEBUG";
 #endif
 
+#ifdef NNUE_STATS
+    compiler += " NNUE_STATS";
+#endif
+
     compiler += "\nCompiler __VERSION__ macro : ";
 #ifdef __VERSION__
     compiler += __VERSION__;
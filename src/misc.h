@@ -141,6 +141,8 @@ class ValueList {
     }
     const T* begin() const { return values_; }
     const T* end() const { return values_ + size_; }
+    T*       begin() { return values_; }
+    T*       end() { return values_ + size_; }
     const T& operator[](int index) const { return values_[index]; }
 
     T* make_space(size_t count) {
@@ -266,27 +268,27 @@ class PRNG {
 
     uint64_t s;
 
-    uint64_t rand64() {
+    constexpr uint64_t rand64() {
 
         s ^= s >> 12, s ^= s << 25, s ^= s >> 27;
         return s * 2685821657736338717LL;
     }
 
    public:
-    PRNG(uint64_t seed) :
+    constexpr PRNG(uint64_t seed) :
         s(seed) {
         assert(seed);
     }
 
     template<typename T>
-    T rand() {
+    constexpr T rand() {
         return T(rand64());
     }
 
     // Special generator used to fast init magic numbers.
     // Output values only have 1/8th of their bits set on average.
     template<typename T>
-    T sparse_rand() {
+    constexpr T sparse_rand() {
         return T(rand64() & rand64() & rand64());
     }
 };
@@ -206,7 +206,7 @@ Move* generate_pawn_moves(const Position& pos, Move* moveList, Bitboard target)
 }
 
 
-template<Color Us, PieceType Pt>
+template<Color Us, PieceType Pt, bool Legal = false>
 Move* generate_moves(const Position& pos, Move* moveList, Bitboard target) {
 
     static_assert(Pt != KING && Pt != PAWN, "Unsupported piece type in generate_moves()");
@@ -218,6 +218,10 @@ Move* generate_moves(const Position& pos, Move* moveList, Bitboard target) {
         Square   from = pop_lsb(bb);
         Bitboard b    = attacks_bb<Pt>(from, pos.pieces()) & target;
 
+        // A pinned piece may only move along the line through it and the king
+        if (Legal && (pos.blockers_for_king(Us) & from))
+            b &= line_bb(pos.square<KING>(Us), from);
+
         moveList = splat_moves(moveList, from, b);
     }
 
@@ -260,6 +264,91 @@ Move* generate_all(const Position& pos, Move* moveList) {
     return moveList;
 }
 
+
+// Returns the squares attacked by the given side, with sliders seeing through
+// the enemy king so that it cannot step back along the ray of a checker.
+template<Color Them>
+Bitboard attacked_squares(const Position& pos) {
+
+    const Bitboard occupied = pos.pieces() ^ pos.square<KING>(~Them);
+
+    Bitboard attacked = pawn_attacks_bb<Them>(pos.pieces(Them, PAWN))
+                      | attacks_bb<KING>(pos.square<KING>(Them));
+
+    for (Bitboard b = pos.pieces(Them, KNIGHT); b;)
+        attacked |= attacks_bb<KNIGHT>(pop_lsb(b));
+
+    for (Bitboard b = pos.pieces(Them, BISHOP, QUEEN); b;)
+        attacked |= attacks_bb<BISHOP>(pop_lsb(b), occupied);
+
+    for (Bitboard b = pos.pieces(Them, ROOK, QUEEN); b;)
+        attacked |= attacks_bb<ROOK>(pop_lsb(b), occupied);
+
+    return attacked;
+}
+
+
+// Generates the legal moves directly. Pinned pieces are restricted to their pin
+// rays and the king to the squares not attacked by the opponent, so that only
+// moves of pinned pawns and en passant captures still need a check.
+template<Color Us>
+Move* generate_legal(const Position& pos, Move* moveList) {
+
+    constexpr Color Them = ~Us;
+
+    const Square   ksq      = pos.square<KING>(Us);
+    const Bitboard checkers = pos.checkers();
+    Bitboard       kingMoves = attacks_bb<KING>(ksq) & ~pos.pieces(Us);
+    Bitboard       attacked  = 0;
+
+    if (kingMoves || (!checkers && pos.can_castle(Us & ANY_CASTLING)))
+        attacked = attacked_squares<Them>(pos);
+
+    // Skip generating non-king moves when in double check
+    if (!more_than_one(checkers))
+    {
+        Bitboard target = checkers ? between_bb(ksq, lsb(checkers)) : ~pos.pieces(Us);
+        Move*    cur    = moveList;
+
+        moveList = checkers ? generate_pawn_moves<Us, EVASIONS>(pos, moveList, target)
+                            : generate_pawn_moves<Us, NON_EVASIONS>(pos, moveList, target);
+
+        if ((pos.blockers_for_king(Us) & pos.pieces(Us, PAWN)) || pos.ep_square() != SQ_NONE)
+        {
+            while (cur != moveList)
+                if (((pos.blockers_for_king(Us) & cur->from_sq())
+                     || cur->type_of() == EN_PASSANT)
+                    && !pos.legal(*cur))
+                    *cur = *(--moveList);
+                else
+                    ++cur;
+        }
+
+        moveList = generate_moves<Us, KNIGHT, true>(pos, moveList, target);
+        moveList = generate_moves<Us, BISHOP, true>(pos, moveList, target);
+        moveList = generate_moves<Us, ROOK, true>(pos, moveList, target);
+        moveList = generate_moves<Us, QUEEN, true>(pos, moveList, target);
+    }
+
+    moveList = splat_moves(moveList, ksq, kingMoves & ~attacked);
+
+    if (!checkers && pos.can_castle(Us & ANY_CASTLING))
+        for (CastlingRights cr : {Us & KING_SIDE, Us & QUEEN_SIDE})
+            if (!pos.castling_impeded(cr) && pos.can_castle(cr))
+            {
+                // The king must not pass through or land on an attacked square.
+                // In Chess960 the castling rook may also be shielding the king.
+                Square rsq = pos.castling_rook_square(cr);
+                Square kto = relative_square(Us, rsq > ksq ? SQ_G1 : SQ_C1);
+
+                if (!(between_bb(ksq, kto) & attacked)
+                    && (!pos.is_chess960() || !(pos.blockers_for_king(Us) & rsq)))
+                    *moveList++ = Move::make<CASTLING>(ksq, rsq);
+            }
+
+    return moveList;
+}
+
 }  // namespace
 
 
@@ -288,25 +377,11 @@ template Move* generate<EVASIONS>(const Position&, Move*);
 template Move* generate<NON_EVASIONS>(const Position&, Move*);
 
 // generate<LEGAL> generates all the legal moves in the given position
-
 template<>
 Move* generate<LEGAL>(const Position& pos, Move* moveList) {
 
-    Color    us     = pos.side_to_move();
-    Bitboard pinned = pos.blockers_for_king(us) & pos.pieces(us);
-    Square   ksq    = pos.square<KING>(us);
-    Move*    cur    = moveList;
-
-    moveList =
-      pos.checkers() ? generate<EVASIONS>(pos, moveList) : generate<NON_EVASIONS>(pos, moveList);
-    while (cur != moveList)
-        if (((pinned & cur->from_sq()) || cur->from_sq() == ksq || cur->type_of() == EN_PASSANT)
-            && !pos.legal(*cur))
-            *cur = *(--moveList);
-        else
-            ++cur;
-
-    return moveList;
+    return pos.side_to_move() == WHITE ? generate_legal<WHITE>(pos, moveList)
+                                       : generate_legal<BLACK>(pos, moveList);
 }
 
 }  // namespace Stockfish
@@ -234,7 +234,7 @@ top:
 
     case GOOD_CAPTURE :
         if (select([&]() {
-                if (pos.see_ge(*cur, -cur->value / 18))
+                if (see_ge(*cur, -cur->value / 18))
                     return true;
                 std::swap(*endBadCaptures++, *cur);
                 return false;
@@ -301,7 +301,7 @@ top:
         return select([]() { return true; });
 
     case PROBCUT :
-        return select([&]() { return pos.see_ge(*cur, threshold); });
+        return select([&]() { return see_ge(*cur, threshold); });
     }
 
     assert(false);
@@ -310,4 +310,33 @@ top:
 
 void MovePicker::skip_quiet_moves() { skipQuiets = true; }
 
+// Tests whether the SEE value of a move is at least the given threshold. As
+// see_ge() is monotonic in the threshold, the bounds it has shown for the
+// last tested move answer the repeated tests of a node without a new swap,
+// e.g. the search pruning a capture the move picker already tested.
+bool MovePicker::see_ge(Move m, int th) {
+
+    if (m != seeMove)
+    {
+        seeMove = m;
+        seeLow  = std::numeric_limits<int>::min();
+        seeHigh = std::numeric_limits<int>::max();
+    }
+
+    if (th <= seeLow)
+        return true;
+
+    if (th > seeHigh)
+        return false;
+
+    bool result = pos.see_ge(m, th);
+
+    if (result)
+        seeLow = th;
+    else
+        seeHigh = th - 1;
+
+    return result;
+}
+
 }  // namespace Stockfish
@@ -50,6 +50,7 @@ class MovePicker {
     MovePicker(const Position&, Move, int, const CapturePieceToHistory*);
     Move next_move();
     void skip_quiet_moves();
+    bool see_ge(Move m, int th);
 
    private:
     template<typename Pred>
@@ -72,6 +73,8 @@ class MovePicker {
     Depth                        depth;
     int                          ply;
     bool                         skipQuiets = false;
+    Move                         seeMove    = Move::none();
+    int                          seeLow, seeHigh;
     ExtMove                      moves[MAX_MOVES];
 };
 
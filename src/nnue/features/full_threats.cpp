@@ -20,10 +20,14 @@
 
 #include "full_threats.h"
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <initializer_list>
+#include <memory>
+#include <numeric>
 #include <utility>
+#include <vector>
 
 #include "../../bitboard.h"
 #include "../../misc.h"
@@ -332,4 +336,47 @@ bool FullThreats::requires_refresh(const DiffType& diff, Color perspective) {
     return perspective == diff.us && (int8_t(diff.ksq) & 0b100) != (int8_t(diff.prevKsq) & 0b100);
 }
 
+namespace {
+
+std::unique_ptr<std::atomic<std::uint64_t>[]> hitHistogram;
+
+auto rowOrder = []() {
+    std::array<IndexType, FullThreats::Dimensions> order{};
+    std::iota(order.begin(), order.end(), 0);
+    return order;
+}();
+
+}  // namespace
+
+void FullThreats::start_hit_histogram() {
+    hitHistogram = std::make_unique<std::atomic<std::uint64_t>[]>(Dimensions);
+    hitCounts    = hitHistogram.get();
+}
+
+std::vector<std::uint64_t> FullThreats::stop_hit_histogram() {
+    std::vector<std::uint64_t> hits;
+
+    if (hitCounts)
+        for (IndexType i = 0; i < Dimensions; ++i)
+            hits.push_back(hitCounts[i].load(std::memory_order_relaxed));
+
+    hitCounts = nullptr;
+    hitHistogram.reset();
+    return hits;
+}
+
+void FullThreats::set_row_order(const std::vector<std::uint64_t>& hits) {
+    std::vector<IndexType> features(Dimensions);
+    std::iota(features.begin(), features.end(), 0);
+
+    if (hits.size() == Dimensions)
+        std::stable_sort(features.begin(), features.end(),
+                         [&](IndexType a, IndexType b) { return hits[a] > hits[b]; });
+
+    for (IndexType row = 0; row < Dimensions; ++row)
+        rowOrder[features[row]] = row;
+}
+
+const std::array<IndexType, FullThreats::Dimensions>& FullThreats::row_order() { return rowOrder; }
+
 }  // namespace Stockfish::Eval::NNUE::Features
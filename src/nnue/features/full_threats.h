@@ -18,7 +18,10 @@
 #ifndef NNUE_FEATURES_FULL_THREATS_INCLUDED
 #define NNUE_FEATURES_FULL_THREATS_INCLUDED
 
+#include <array>
+#include <atomic>
 #include <cstdint>
+#include <vector>
 
 #include "../../misc.h"
 #include "../../types.h"
@@ -97,6 +100,26 @@ class FullThreats {
     // Returns whether the change stored in this DirtyPiece means
     // that a full accumulator refresh is required.
     static bool requires_refresh(const DiffType& diff, Color perspective);
+
+    // Histogram of the features used by accumulator updates on all threads,
+    // recorded between start_hit_histogram() and stop_hit_histogram(). Only
+    // builds with NNUE_STATS record anything.
+    static void                       start_hit_histogram();
+    static std::vector<std::uint64_t> stop_hit_histogram();
+    static bool                       recording_hits() { return hitCounts != nullptr; }
+    static void                       record_hits(const IndexList& indices) {
+        for (auto index : indices)
+            hitCounts[index].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Rows in which the weights of the features are stored, the most used
+    // features first so that hot rows share pages. The identity until set
+    // from a hit histogram, an empty histogram restores it.
+    static void set_row_order(const std::vector<std::uint64_t>& hits);
+    static const std::array<IndexType, Dimensions>& row_order();
+
+   private:
+    static inline std::atomic<std::uint64_t>* hitCounts = nullptr;
 };
 
 }  // namespace Stockfish::Eval::NNUE::Features
@@ -23,6 +23,8 @@
 #include <iostream>
 #include <optional>
 #include <type_traits>
+#include <utility>
+#include <variant>
 #include <vector>
 
 #define INCBIN_SILENCE_BITCODE_WARNING
@@ -184,11 +186,19 @@ Network<Arch, Transformer>::evaluate(const Position&                         pos
     const int  bucket = (pos.count<ALL_PIECES>() - 1) / 4;
     const auto psqt =
       featureTransformer.transform(pos, accumulatorStack, cache, transformedFeatures, bucket);
-    const auto positional = network[bucket].propagate(transformedFeatures);
+    const auto positional = std::visit(
+      [&](const auto& stacks) { return stacks[bucket].propagate(transformedFeatures); }, network);
     return {static_cast<Value>(psqt / OutputScale), static_cast<Value>(positional / OutputScale)};
 }
 
 
+template<typename Arch, typename Transformer>
+void Network<Arch, Transformer>::prefetch_weights(const Position&   pos,
+                                                  const DirtyPiece& dp) const {
+    featureTransformer.prefetch_changed_rows(pos, dp);
+}
+
+
 template<typename Arch, typename Transformer>
 void Network<Arch, Transformer>::verify(std::string                                  evalfilePath,
                                         const std::function<void(std::string_view)>& f) const {
@@ -220,12 +230,22 @@ void Network<Arch, Transformer>::verify(std::string
 
     if (f)
     {
-        size_t size = sizeof(featureTransformer) + sizeof(Arch) * LayerStacks;
-        f("NNUE evaluation using " + evalfilePath + " (" + std::to_string(size / (1024 * 1024))
-          + "MiB, (" + std::to_string(featureTransformer.TotalInputDimensions) + ", "
-          + std::to_string(network[0].TransformedFeatureDimensions) + ", "
-          + std::to_string(network[0].FC_0_OUTPUTS) + ", " + std::to_string(network[0].FC_1_OUTPUTS)
-          + ", 1))");
+        std::visit(
+          [&](const auto& stacks) {
+              size_t size = sizeof(featureTransformer) + sizeof(stacks);
+              f("NNUE evaluation using " + evalfilePath + " ("
+                + std::to_string(size / (1024 * 1024)) + "MiB, ("
+                + std::to_string(featureTransformer.TotalInputDimensions) + ", "
+                + std::to_string(stacks[0].TransformedFeatureDimensions) + ", "
+                + std::to_string(stacks[0].FC_0_OUTPUTS) + ", "
+                + std::to_string(stacks[0].FC_1_OUTPUTS) + ", 1))");
+          },
+          network);
+
+        if (featureTransformer.saturatedPSQWeights)
+            f("NNUE evaluation: " + std::to_string(featureTransformer.saturatedPSQWeights)
+              + " of " + std::to_string(featureTransformer.weights.size())
+              + " PSQ weights saturated converting " + evalfilePath + " to int8");
     }
 }
 
@@ -249,7 +269,9 @@ Network<Arch, Transformer>::trace_evaluate(const Position&
     {
         const auto materialist =
           featureTransformer.transform(pos, accumulatorStack, cache, transformedFeatures, bucket);
-        const auto positional = network[bucket].propagate(transformedFeatures);
+        const auto positional = std::visit(
+          [&](const auto& stacks) { return stacks[bucket].propagate(transformedFeatures); },
+          network);
 
         t.psqt[bucket]       = static_cast<Value>(materialist / OutputScale);
         t.positional[bucket] = static_cast<Value>(positional / OutputScale);
@@ -259,6 +281,12 @@ Network<Arch, Transformer>::trace_evaluate(const Position&
 }
 
 
+template<typename Arch, typename Transformer>
+void Network<Arch, Transformer>::apply_threat_row_order() {
+    featureTransformer.apply_threat_row_order();
+}
+
+
 template<typename Arch, typename Transformer>
 void Network<Arch, Transformer>::load_user_net(const std::string& dir,
                                                const std::string& evalfilePath) {
@@ -333,8 +361,12 @@ std::size_t Network<Arch, Transformer>::get_content_hash() const {
 
     std::size_t h = 0;
     hash_combine(h, featureTransformer);
-    for (auto&& layerstack : network)
-        hash_combine(h, layerstack);
+    std::visit(
+      [&](const auto& stacks) {
+          for (auto&& layerstack : stacks)
+              hash_combine(h, layerstack);
+      },
+      network);
     hash_combine(h, evalFile);
     hash_combine(h, static_cast<int>(embeddedType));
     return h;
@@ -377,32 +409,83 @@ bool Network<Arch, Transformer>::read_parameters(std::istream& stream,
     std::uint32_t hashValue;
     if (!read_header(stream, &hashValue, &netDescription))
         return false;
-    if (hashValue != Network::hash)
-        return false;
-    if (!Detail::read_parameters(stream, featureTransformer))
-        return false;
-    for (std::size_t i = 0; i < LayerStacks; ++i)
+
+    // Builds with int8 PSQ weights also accept the nets storing them as int16
+    bool narrowPSQWeights = false;
+    if (!select_layer_stacks(hashValue ^ Transformer::get_hash_value()))
     {
-        if (!Detail::read_parameters(stream, network[i]))
+        if (!Transformer::Int8PSQWeights
+            || !select_layer_stacks(hashValue ^ Transformer::get_hash_value(false)))
             return false;
+        narrowPSQWeights = true;
     }
-    return stream && stream.peek() == std::ios::traits_type::eof();
+
+    const bool          int8PSQWeights = Transformer::Int8PSQWeights && !narrowPSQWeights;
+    const std::uint32_t header         = read_little_endian<std::uint32_t>(stream);
+    if (!stream || header != Transformer::get_hash_value(int8PSQWeights)
+        || !featureTransformer.read_parameters(stream, narrowPSQWeights))
+        return false;
+
+    bool ok = std::visit(
+      [&](auto& stacks) {
+          for (auto& layerstack : stacks)
+              if (!Detail::read_parameters(stream, layerstack))
+                  return false;
+          return true;
+      },
+      network);
+
+    return ok && stream && stream.peek() == std::ios::traits_type::eof();
 }
 
 
 template<typename Arch, typename Transformer>
 bool Network<Arch, Transformer>::write_parameters(std::ostream&      stream,
                                                   const std::string& netDescription) const {
-    if (!write_header(stream, Network::hash, netDescription))
+    if (!write_header(stream, get_hash_value(), netDescription))
         return false;
     if (!Detail::write_parameters(stream, featureTransformer))
         return false;
-    for (std::size_t i = 0; i < LayerStacks; ++i)
+
+    bool ok = std::visit(
+      [&](const auto& stacks) {
+          for (const auto& layerstack : stacks)
+              if (!Detail::write_parameters(stream, layerstack))
+                  return false;
+          return true;
+      },
+      network);
+
+    return ok && bool(stream);
+}
+
+// Switches the layer stacks to the sizes whose hash is given, as read from
+// the header of a network file. Returns false if no sizes match.
+template<typename Arch, typename Transformer>
+template<std::size_t I>
+bool Network<Arch, Transformer>::select_layer_stacks(std::uint32_t archHash) {
+    using Variant = LayerStackVariant<Arch>;
+
+    if constexpr (I == std::variant_size_v<Variant>)
+        return false;
+    else
     {
-        if (!Detail::write_parameters(stream, network[i]))
-            return false;
+        using Stack = typename std::variant_alternative_t<I, Variant>::value_type;
+
+        if (Stack::get_hash_value() != archHash)
+            return select_layer_stacks<I + 1>(archHash);
+
+        if (network.index() != I)
+            network.template emplace<I>();
+        return true;
     }
-    return bool(stream);
+}
+
+void Networks::update_accumulators(const Position&    pos,
+                                   AccumulatorStack&  accumulatorStack,
+                                   AccumulatorCaches& caches) const {
+    accumulatorStack.evaluate(pos, small.featureTransformer, caches.small, big.featureTransformer,
+                              caches.big);
 }
 
 // Explicit template instantiations
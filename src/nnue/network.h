@@ -28,6 +28,7 @@
 #include <string>
 #include <string_view>
 #include <tuple>
+#include <variant>
 
 #include "../misc.h"
 #include "../types.h"
@@ -78,7 +79,10 @@ class Network {
                            AccumulatorCaches::Cache<FTDimensions>& cache) const;
 
 
+    void prefetch_weights(const Position& pos, const DirtyPiece& dp) const;
+
     void verify(std::string evalfilePath, const std::function<void(std::string_view)>&) const;
+    void apply_threat_row_order();
     NnueEvalTrace trace_evaluate(const Position&                         pos,
                                  AccumulatorStack&                       accumulatorStack,
                                  AccumulatorCaches::Cache<FTDimensions>& cache) const;
@@ -98,22 +102,30 @@ class Network {
     bool read_parameters(std::istream&, std::string&);
     bool write_parameters(std::ostream&, const std::string&) const;
 
+    template<std::size_t I = 0>
+    bool select_layer_stacks(std::uint32_t archHash);
+
+    // Hash value of evaluation function structure
+    std::uint32_t get_hash_value() const {
+        return Transformer::get_hash_value()
+             ^ std::visit([](const auto& stacks) { return stacks[0].get_hash_value(); }, network);
+    }
+
     // Input feature converter
     Transformer featureTransformer;
 
-    // Evaluation function
-    Arch network[LayerStacks];
+    // Evaluation function, one layer stack per bucket
+    LayerStackVariant<Arch> network;
 
     EvalFile         evalFile;
     EmbeddedNNUEType embeddedType;
 
     bool initialized = false;
 
-    // Hash value of evaluation function structure
-    static constexpr std::uint32_t hash = Transformer::get_hash_value() ^ Arch::get_hash_value();
-
     template<IndexType Size>
     friend struct AccumulatorCaches::Cache;
+
+    friend struct Networks;
 };
 
 // Definitions of the network types
@@ -133,6 +145,11 @@ struct Networks {
         big(bigFile, EmbeddedNNUEType::BIG),
         small(smallFile, EmbeddedNNUEType::SMALL) {}
 
+    // Brings the accumulators of both nets up to date in one interleaved pass
+    void update_accumulators(const Position&    pos,
+                             AccumulatorStack&  accumulatorStack,
+                             AccumulatorCaches& caches) const;
+
     NetworkBig   big;
     NetworkSmall small;
 };
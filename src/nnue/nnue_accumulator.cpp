@@ -18,10 +18,16 @@
 
 #include "nnue_accumulator.h"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
 #include <new>
 #include <type_traits>
+#include <utility>
 
 #include "../bitboard.h"
 #include "../misc.h"
@@ -39,6 +45,9 @@ using namespace SIMD;
 
 namespace {
 
+// Longest run of plies caught up in a single pass over the accumulator
+constexpr std::size_t MaxFusedPlies = 8;
+
 template<IndexType TransformedFeatureDimensions>
 void double_inc_update(Color                                                   perspective,
                        const FeatureTransformer<TransformedFeatureDimensions>& featureTransformer,
@@ -56,6 +65,13 @@ void double_inc_update(Color                                                   p
                        const AccumulatorState<ThreatFeatureSet>&               computed,
                        const DirtyPiece&                                       dp2);
 
+template<typename FeatureSet, IndexType TransformedFeatureDimensions>
+void multi_inc_update(Color                                                   perspective,
+                      const FeatureTransformer<TransformedFeatureDimensions>& featureTransformer,
+                      const Square                                            ksq,
+                      AccumulatorState<FeatureSet>* const*                    states,
+                      std::size_t                                             count);
+
 template<bool Forward, typename FeatureSet, IndexType TransformedFeatureDimensions>
 void update_accumulator_incremental(
   Color                                                   perspective,
@@ -72,15 +88,31 @@ void update_accumulator_refresh_cache(Color                                 pers
                                       AccumulatorCaches::Cache<Dimensions>& cache);
 
 template<IndexType Dimensions>
-void update_threats_accumulator_full(Color                                 perspective,
-                                     const FeatureTransformer<Dimensions>& featureTransformer,
-                                     const Position&                       pos,
-                                     AccumulatorState<ThreatFeatureSet>&   accumulatorState);
+void update_threats_accumulator_refresh_cache(
+  Color                                 perspective,
+  const FeatureTransformer<Dimensions>& featureTransformer,
+  const Position&                       pos,
+  AccumulatorState<ThreatFeatureSet>&   accumulatorState,
+  AccumulatorCaches::Cache<Dimensions>& cache);
+}
+
+AccumulatorStack::AccumulatorStack() :
+    pages(static_cast<Page*>(std_aligned_alloc(alignof(Page), PageCount * sizeof(Page)))) {
+    static_assert(std::is_trivially_destructible_v<Page>);
+
+    if (!pages)
+    {
+        std::cerr << "Failed to allocate " << PageCount * sizeof(Page) / 1024
+                  << "kB for the accumulator stack." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    new (pages.get()) Page();
 }
 
 template<typename T>
 const AccumulatorState<T>& AccumulatorStack::latest() const noexcept {
-    return accumulators<T>()[size - 1];
+    return state<T>(size - 1);
 }
 
 // Explicit template instantiations
@@ -89,45 +121,48 @@ template const AccumulatorState<ThreatFeatureSet>& AccumulatorStack::latest() co
 
 template<typename T>
 AccumulatorState<T>& AccumulatorStack::mut_latest() noexcept {
-    return mut_accumulators<T>()[size - 1];
+    return mut_state<T>(size - 1);
 }
 
 template<typename T>
-const std::array<AccumulatorState<T>, AccumulatorStack::MaxSize>&
-AccumulatorStack::accumulators() const noexcept {
+const AccumulatorState<T>& AccumulatorStack::state(std::size_t idx) const noexcept {
     static_assert(std::is_same_v<T, PSQFeatureSet> || std::is_same_v<T, ThreatFeatureSet>,
                   "Invalid Feature Set Type");
+    assert(idx < MaxSize && idx / PagePlies < constructedPages);
+
+    const Page& page = pages.get()[idx / PagePlies];
 
     if constexpr (std::is_same_v<T, PSQFeatureSet>)
-        return psq_accumulators;
+        return page.psq_accumulators[idx % PagePlies];
 
     if constexpr (std::is_same_v<T, ThreatFeatureSet>)
-        return threat_accumulators;
+        return page.threat_accumulators[idx % PagePlies];
 }
 
 template<typename T>
-std::array<AccumulatorState<T>, AccumulatorStack::MaxSize>&
-AccumulatorStack::mut_accumulators() noexcept {
-    static_assert(std::is_same_v<T, PSQFeatureSet> || std::is_same_v<T, ThreatFeatureSet>,
-                  "Invalid Feature Set Type");
-
-    if constexpr (std::is_same_v<T, PSQFeatureSet>)
-        return psq_accumulators;
+AccumulatorState<T>& AccumulatorStack::mut_state(std::size_t idx) noexcept {
+    return const_cast<AccumulatorState<T>&>(std::as_const(*this).state<T>(idx));
+}
 
-    if constexpr (std::is_same_v<T, ThreatFeatureSet>)
-        return threat_accumulators;
+std::size_t AccumulatorStack::resident_size() const noexcept {
+    return sizeof(Page) * constructedPages;
 }
 
 void AccumulatorStack::reset() noexcept {
-    psq_accumulators[0].reset({});
-    threat_accumulators[0].reset({});
+    mut_state<PSQFeatureSet>(0).reset({});
+    mut_state<ThreatFeatureSet>(0).reset({});
     size = 1;
 }
 
 std::pair<DirtyPiece&, DirtyThreats&> AccumulatorStack::push() noexcept {
     assert(size < MaxSize);
-    auto& dp  = psq_accumulators[size].reset();
-    auto& dts = threat_accumulators[size].reset();
+
+    // Pages are reached in order, so at most the next one needs constructing
+    if (size / PagePlies == constructedPages)
+        new (pages.get() + constructedPages++) Page();
+
+    auto& dp  = mut_state<PSQFeatureSet>(size).reset();
+    auto& dts = mut_state<ThreatFeatureSet>(size).reset();
     new (&dts) DirtyThreats;
     size++;
     return {dp, dts};
@@ -155,6 +190,80 @@ void AccumulatorStack::evaluate(const Position&                       pos,
         evaluate_side<ThreatFeatureSet>(BLACK, pos, featureTransformer, cache);
 }
 
+void AccumulatorStack::evaluate(
+  const Position&                                              pos,
+  const FeatureTransformer<TransformedFeatureDimensionsSmall>& smallTransformer,
+  AccumulatorCaches::Cache<TransformedFeatureDimensionsSmall>& smallCache,
+  const FeatureTransformer<TransformedFeatureDimensionsBig>&   bigTransformer,
+  AccumulatorCaches::Cache<TransformedFeatureDimensionsBig>&   bigCache) noexcept {
+
+    evaluate_side_interleaved(WHITE, pos, smallTransformer, smallCache, bigTransformer, bigCache);
+    evaluate_side_interleaved(BLACK, pos, smallTransformer, smallCache, bigTransformer, bigCache);
+}
+
+// Catches up the small net accumulator and both big net accumulators of one
+// perspective. The plies that only need incremental updates are walked once,
+// updating the three accumulators in turn at each ply, so that the weight row
+// loads of one net overlap the accumulation of the others. An accumulator that
+// needs a refresh is caught up on its own first.
+void AccumulatorStack::evaluate_side_interleaved(
+  Color                                                        perspective,
+  const Position&                                              pos,
+  const FeatureTransformer<TransformedFeatureDimensionsSmall>& smallTransformer,
+  AccumulatorCaches::Cache<TransformedFeatureDimensionsSmall>& smallCache,
+  const FeatureTransformer<TransformedFeatureDimensionsBig>&   bigTransformer,
+  AccumulatorCaches::Cache<TransformedFeatureDimensionsBig>&   bigCache) noexcept {
+
+    constexpr IndexType Small = TransformedFeatureDimensionsSmall;
+    constexpr IndexType Big   = TransformedFeatureDimensionsBig;
+
+    std::size_t smallBegin  = find_last_usable_accumulator<PSQFeatureSet, Small>(perspective);
+    std::size_t bigBegin    = find_last_usable_accumulator<PSQFeatureSet, Big>(perspective);
+    std::size_t threatBegin = find_last_usable_accumulator<ThreatFeatureSet, Big>(perspective);
+
+    if (!(state<PSQFeatureSet>(smallBegin).acc<Small>()).computed[perspective])
+    {
+        evaluate_side<PSQFeatureSet>(perspective, pos, smallTransformer, smallCache);
+        smallBegin = size - 1;
+    }
+
+    if (!(state<PSQFeatureSet>(bigBegin).acc<Big>()).computed[perspective])
+    {
+        evaluate_side<PSQFeatureSet>(perspective, pos, bigTransformer, bigCache);
+        bigBegin = size - 1;
+    }
+
+    if (!(state<ThreatFeatureSet>(threatBegin).acc<Big>()).computed[perspective])
+    {
+        evaluate_side<ThreatFeatureSet>(perspective, pos, bigTransformer, bigCache);
+        threatBegin = size - 1;
+    }
+
+    const Square ksq = pos.square<KING>(perspective);
+
+    for (std::size_t next = std::min({smallBegin, bigBegin, threatBegin}) + 1; next < size; next++)
+    {
+        if (next > smallBegin)
+            update_accumulator_incremental<true>(perspective, smallTransformer, ksq,
+                                                 mut_state<PSQFeatureSet>(next),
+                                                 state<PSQFeatureSet>(next - 1));
+
+        if (next > bigBegin)
+            update_accumulator_incremental<true>(perspective, bigTransformer, ksq,
+                                                 mut_state<PSQFeatureSet>(next),
+                                                 state<PSQFeatureSet>(next - 1));
+
+        if (next > threatBegin)
+            update_accumulator_incremental<true>(perspective, bigTransformer, ksq,
+                                                 mut_state<ThreatFeatureSet>(next),
+                                                 state<ThreatFeatureSet>(next - 1));
+    }
+
+    assert((latest<PSQFeatureSet>().acc<Small>()).computed[perspective]);
+    assert((latest<PSQFeatureSet>().acc<Big>()).computed[perspective]);
+    assert((latest<ThreatFeatureSet>().acc<Big>()).computed[perspective]);
+}
+
 template<typename FeatureSet, IndexType Dimensions>
 void AccumulatorStack::evaluate_side(Color                                 perspective,
                                      const Position&                       pos,
@@ -164,7 +273,7 @@ void AccumulatorStack::evaluate_side(Color                                 persp
     const auto last_usable_accum =
       find_last_usable_accumulator<FeatureSet, Dimensions>(perspective);
 
-    if ((accumulators<FeatureSet>()[last_usable_accum].template acc<Dimensions>())
+    if ((state<FeatureSet>(last_usable_accum).template acc<Dimensions>())
           .computed[perspective])
         forward_update_incremental<FeatureSet>(perspective, pos, featureTransformer,
                                                last_usable_accum);
@@ -175,8 +284,8 @@ void AccumulatorStack::evaluate_side(Color                                 persp
             update_accumulator_refresh_cache(perspective, featureTransformer, pos,
                                              mut_latest<PSQFeatureSet>(), cache);
         else
-            update_threats_accumulator_full(perspective, featureTransformer, pos,
-                                            mut_latest<ThreatFeatureSet>());
+            update_threats_accumulator_refresh_cache(perspective, featureTransformer, pos,
+                                                     mut_latest<ThreatFeatureSet>(), cache);
 
         backward_update_incremental<FeatureSet>(perspective, pos, featureTransformer,
                                                 last_usable_accum);
@@ -190,10 +299,10 @@ std::size_t AccumulatorStack::find_last_usable_accumulator(Color perspective) co
 
     for (std::size_t curr_idx = size - 1; curr_idx > 0; curr_idx--)
     {
-        if ((accumulators<FeatureSet>()[curr_idx].template acc<Dimensions>()).computed[perspective])
+        if ((state<FeatureSet>(curr_idx).template acc<Dimensions>()).computed[perspective])
             return curr_idx;
 
-        if (FeatureSet::requires_refresh(accumulators<FeatureSet>()[curr_idx].diff, perspective))
+        if (FeatureSet::requires_refresh(state<FeatureSet>(curr_idx).diff, perspective))
             return curr_idx;
     }
 
@@ -207,50 +316,81 @@ void AccumulatorStack::forward_update_incremental(
   const FeatureTransformer<Dimensions>& featureTransformer,
   const std::size_t                     begin) noexcept {
 
-    assert(begin < accumulators<FeatureSet>().size());
-    assert((accumulators<FeatureSet>()[begin].template acc<Dimensions>()).computed[perspective]);
+    assert(begin < MaxSize);
+    assert((state<FeatureSet>(begin).template acc<Dimensions>()).computed[perspective]);
 
     const Square ksq = pos.square<KING>(perspective);
 
+    // Whether the plies at idx and idx + 1 are caught up by double_inc_update()
+    auto fuses_with_next = [&](std::size_t idx) {
+        if (idx + 1 >= size)
+            return false;
+
+        const DirtyPiece& dp1 = state<PSQFeatureSet>(idx).diff;
+        const DirtyPiece& dp2 = state<PSQFeatureSet>(idx + 1).diff;
+
+        if constexpr (std::is_same_v<FeatureSet, ThreatFeatureSet>)
+            return dp2.remove_sq != SQ_NONE
+                && bool(state<FeatureSet>(idx).diff.threateningSqs & square_bb(dp2.remove_sq));
+        else
+            return dp1.to != SQ_NONE && dp1.to == dp2.remove_sq;
+    };
+
+#ifdef NNUE_STATS
+    dbg_mean_of(size - 1 - begin, 0);
+#endif
+
     for (std::size_t next = begin + 1; next < size; next++)
     {
-        if (next + 1 < size)
+        if (fuses_with_next(next))
         {
-            DirtyPiece& dp1 = mut_accumulators<PSQFeatureSet>()[next].diff;
-            DirtyPiece& dp2 = mut_accumulators<PSQFeatureSet>()[next + 1].diff;
-
-            auto& accumulators = mut_accumulators<FeatureSet>();
-
             if constexpr (std::is_same_v<FeatureSet, ThreatFeatureSet>)
+                double_inc_update(perspective, featureTransformer, ksq,
+                                  mut_state<FeatureSet>(next), mut_state<FeatureSet>(next + 1),
+                                  state<FeatureSet>(next - 1), state<PSQFeatureSet>(next + 1).diff);
+            else
             {
-                if (dp2.remove_sq != SQ_NONE
-                    && (accumulators[next].diff.threateningSqs & square_bb(dp2.remove_sq)))
-                {
-                    double_inc_update(perspective, featureTransformer, ksq, accumulators[next],
-                                      accumulators[next + 1], accumulators[next - 1], dp2);
-                    next++;
-                    continue;
-                }
+                DirtyPiece& dp1 = mut_state<PSQFeatureSet>(next).diff;
+                DirtyPiece& dp2 = mut_state<PSQFeatureSet>(next + 1).diff;
+
+                const Square captureSq = dp1.to;
+                dp1.to = dp2.remove_sq = SQ_NONE;
+                double_inc_update(perspective, featureTransformer, ksq,
+                                  mut_state<FeatureSet>(next), mut_state<FeatureSet>(next + 1),
+                                  state<FeatureSet>(next - 1));
+                dp1.to = dp2.remove_sq = captureSq;
             }
 
-            if constexpr (std::is_same_v<FeatureSet, PSQFeatureSet>)
-            {
-                if (dp1.to != SQ_NONE && dp1.to == dp2.remove_sq)
-                {
-                    const Square captureSq = dp1.to;
-                    dp1.to = dp2.remove_sq = SQ_NONE;
-                    double_inc_update(perspective, featureTransformer, ksq, accumulators[next],
-                                      accumulators[next + 1], accumulators[next - 1]);
-                    dp1.to = dp2.remove_sq = captureSq;
-                    next++;
-                    continue;
-                }
-            }
+            next++;
+            continue;
+        }
+
+        // The following plies, up to the next pair fused above, are caught up
+        // in one pass that reads the accumulator once and keeps the running
+        // values in registers, storing each ply's accumulator on the way.
+        std::size_t last = next + 1;
+        while (last < size && last - next < MaxFusedPlies && !fuses_with_next(last))
+            last++;
+
+#ifdef NNUE_STATS
+        dbg_mean_of(last - next, 1);
+#endif
+
+        if (last == next + 1)
+            update_accumulator_incremental<true>(perspective, featureTransformer, ksq,
+                                                 mut_state<FeatureSet>(next),
+                                                 state<FeatureSet>(next - 1));
+        else
+        {
+            std::array<AccumulatorState<FeatureSet>*, MaxFusedPlies + 1> states;
+
+            for (std::size_t idx = next - 1; idx < last; ++idx)
+                states[idx - (next - 1)] = &mut_state<FeatureSet>(idx);
+
+            multi_inc_update(perspective, featureTransformer, ksq, states.data(), last - next);
         }
 
-        update_accumulator_incremental<true>(perspective, featureTransformer, ksq,
-                                             mut_accumulators<FeatureSet>()[next],
-                                             accumulators<FeatureSet>()[next - 1]);
+        next = last - 1;
     }
 
     assert((latest<PSQFeatureSet>().acc<Dimensions>()).computed[perspective]);
@@ -264,7 +404,7 @@ void AccumulatorStack::backward_update_incremental(
   const FeatureTransformer<Dimensions>& featureTransformer,
   const std::size_t                     end) noexcept {
 
-    assert(end < accumulators<FeatureSet>().size());
+    assert(end < MaxSize);
     assert(end < size);
     assert((latest<FeatureSet>().template acc<Dimensions>()).computed[perspective]);
 
@@ -272,10 +412,10 @@ void AccumulatorStack::backward_update_incremental(
 
     for (std::int64_t next = std::int64_t(size) - 2; next >= std::int64_t(end); next--)
         update_accumulator_incremental<false>(perspective, featureTransformer, ksq,
-                                              mut_accumulators<FeatureSet>()[next],
-                                              accumulators<FeatureSet>()[next + 1]);
+                                              mut_state<FeatureSet>(next),
+                                              state<FeatureSet>(next + 1));
 
-    assert((accumulators<FeatureSet>()[end].template acc<Dimensions>()).computed[perspective]);
+    assert((state<FeatureSet>(end).template acc<Dimensions>()).computed[perspective]);
 }
 
 // Explicit template instantiations
@@ -308,6 +448,52 @@ void fused_row_reduce(const ElementType* in, ElementType* out, const Ts* const..
           vecIn[i], reinterpret_cast<const typename VectorWrapper::type*>(rows)[i]...);
 }
 
+template<typename FeatureSet, IndexType Dimensions>
+const auto* weight_rows(const FeatureTransformer<Dimensions>& featureTransformer) {
+    if constexpr (std::is_same_v<FeatureSet, ThreatFeatureSet>)
+        return &featureTransformer.threatWeights[0];
+    else
+        return &featureTransformer.weights[0];
+}
+
+template<typename FeatureSet, IndexType Dimensions>
+const auto* psqt_weight_rows(const FeatureTransformer<Dimensions>& featureTransformer) {
+    if constexpr (std::is_same_v<FeatureSet, ThreatFeatureSet>)
+        return &featureTransformer.threatPsqtWeights[0];
+    else
+        return &featureTransformer.psqtWeights[0];
+}
+
+#ifdef VECTOR
+// Adds or subtracts one weight row to the registers of a tile. Threat
+// weights, and PSQ weights in int8 builds, are widened on the fly.
+template<UpdateOperation op, IndexType NumRegs, typename WeightT>
+void update_tile(vec_t* acc, const WeightT* row) {
+    if constexpr (sizeof(WeightT) == 1)
+    {
+        auto* column = reinterpret_cast<const vec_i8_t*>(row);
+
+    #ifdef USE_NEON
+        for (IndexType k = 0; k < NumRegs; k += 2)
+        {
+            acc[k]     = fused<Vec16Wrapper, op>(acc[k], vmovl_s8(vget_low_s8(column[k / 2])));
+            acc[k + 1] = fused<Vec16Wrapper, op>(acc[k + 1], vmovl_high_s8(column[k / 2]));
+        }
+    #else
+        for (IndexType k = 0; k < NumRegs; ++k)
+            acc[k] = fused<Vec16Wrapper, op>(acc[k], vec_t(vec_convert_8_16(column[k])));
+    #endif
+    }
+    else
+    {
+        auto* column = reinterpret_cast<const vec_t*>(row);
+
+        for (IndexType k = 0; k < NumRegs; ++k)
+            acc[k] = fused<Vec16Wrapper, op>(acc[k], column[k]);
+    }
+}
+#endif
+
 template<typename FeatureSet, IndexType Dimensions>
 struct AccumulatorUpdateContext {
     Color                                 perspective;
@@ -328,23 +514,33 @@ struct AccumulatorUpdateContext {
              typename... Ts,
              std::enable_if_t<is_all_same_v<IndexType, Ts...>, bool> = true>
     void apply(const Ts... indices) {
-        auto to_weight_vector = [&](const IndexType index) {
-            return &featureTransformer.weights[index * Dimensions];
-        };
-
-        auto to_psqt_weight_vector = [&](const IndexType index) {
-            return &featureTransformer.psqtWeights[index * PSQTBuckets];
-        };
-
-        fused_row_reduce<Vec16Wrapper, Dimensions, ops...>(
-          (from.template acc<Dimensions>()).accumulation[perspective].data(),
-          (to.template acc<Dimensions>()).accumulation[perspective].data(),
-          to_weight_vector(indices)...);
-
-        fused_row_reduce<Vec32Wrapper, PSQTBuckets, ops...>(
-          (from.template acc<Dimensions>()).psqtAccumulation[perspective].data(),
-          (to.template acc<Dimensions>()).psqtAccumulation[perspective].data(),
-          to_psqt_weight_vector(indices)...);
+        // Int8 weight rows need widening, which the list update does
+        if constexpr (FeatureTransformer<Dimensions>::Int8PSQWeights)
+        {
+            typename FeatureSet::IndexList added, removed;
+            ((ops == Add ? added : removed).push_back(indices), ...);
+            apply(added, removed);
+        }
+        else
+        {
+            auto to_weight_vector = [&](const IndexType index) {
+                return &featureTransformer.weights[index * Dimensions];
+            };
+
+            auto to_psqt_weight_vector = [&](const IndexType index) {
+                return &featureTransformer.psqtWeights[index * PSQTBuckets];
+            };
+
+            fused_row_reduce<Vec16Wrapper, Dimensions, ops...>(
+              (from.template acc<Dimensions>()).accumulation[perspective].data(),
+              (to.template acc<Dimensions>()).accumulation[perspective].data(),
+              to_weight_vector(indices)...);
+
+            fused_row_reduce<Vec32Wrapper, PSQTBuckets, ops...>(
+              (from.template acc<Dimensions>()).psqtAccumulation[perspective].data(),
+              (to.template acc<Dimensions>()).psqtAccumulation[perspective].data(),
+              to_psqt_weight_vector(indices)...);
+        }
     }
 
     void apply(const typename FeatureSet::IndexList& added,
@@ -355,13 +551,14 @@ struct AccumulatorUpdateContext {
         const auto& fromPsqtAcc = from.template acc<Dimensions>().psqtAccumulation[perspective];
         auto&       toPsqtAcc   = to.template acc<Dimensions>().psqtAccumulation[perspective];
 
+        const auto* weights     = weight_rows<FeatureSet>(featureTransformer);
+        const auto* psqtWeights = psqt_weight_rows<FeatureSet>(featureTransformer);
+
 #ifdef VECTOR
         using Tiling = SIMDTiling<Dimensions, Dimensions, PSQTBuckets>;
         vec_t      acc[Tiling::NumRegs];
         psqt_vec_t psqt[Tiling::NumPsqtRegs];
 
-        const auto* threatWeights = &featureTransformer.threatWeights[0];
-
         for (IndexType j = 0; j < Dimensions / Tiling::TileHeight; ++j)
         {
             auto* fromTile = reinterpret_cast<const vec_t*>(&fromAcc[j * Tiling::TileHeight]);
@@ -371,45 +568,15 @@ struct AccumulatorUpdateContext {
                 acc[k] = fromTile[k];
 
             for (int i = 0; i < removed.ssize(); ++i)
-            {
-                size_t       index  = removed[i];
-                const size_t offset = Dimensions * index;
-                auto*        column = reinterpret_cast<const vec_i8_t*>(&threatWeights[offset]);
-
-    #ifdef USE_NEON
-                for (IndexType k = 0; k < Tiling::NumRegs; k += 2)
-                {
-                    acc[k]     = vec_sub_16(acc[k], vmovl_s8(vget_low_s8(column[k / 2])));
-                    acc[k + 1] = vec_sub_16(acc[k + 1], vmovl_high_s8(column[k / 2]));
-                }
-    #else
-                for (IndexType k = 0; k < Tiling::NumRegs; ++k)
-                    acc[k] = vec_sub_16(acc[k], vec_convert_8_16(column[k]));
-    #endif
-            }
+                update_tile<Sub, Tiling::NumRegs>(acc, &weights[Dimensions * removed[i]]);
 
             for (int i = 0; i < added.ssize(); ++i)
-            {
-                size_t       index  = added[i];
-                const size_t offset = Dimensions * index;
-                auto*        column = reinterpret_cast<const vec_i8_t*>(&threatWeights[offset]);
-
-    #ifdef USE_NEON
-                for (IndexType k = 0; k < Tiling::NumRegs; k += 2)
-                {
-                    acc[k]     = vec_add_16(acc[k], vmovl_s8(vget_low_s8(column[k / 2])));
-                    acc[k + 1] = vec_add_16(acc[k + 1], vmovl_high_s8(column[k / 2]));
-                }
-    #else
-                for (IndexType k = 0; k < Tiling::NumRegs; ++k)
-                    acc[k] = vec_add_16(acc[k], vec_convert_8_16(column[k]));
-    #endif
-            }
+                update_tile<Add, Tiling::NumRegs>(acc, &weights[Dimensions * added[i]]);
 
             for (IndexType k = 0; k < Tiling::NumRegs; k++)
                 vec_store(&toTile[k], acc[k]);
 
-            threatWeights += Tiling::TileHeight;
+            weights += Tiling::TileHeight;
         }
 
         for (IndexType j = 0; j < PSQTBuckets / Tiling::PsqtTileHeight; ++j)
@@ -426,8 +593,7 @@ struct AccumulatorUpdateContext {
             {
                 size_t       index      = removed[i];
                 const size_t offset     = PSQTBuckets * index + j * Tiling::PsqtTileHeight;
-                auto*        columnPsqt = reinterpret_cast<const psqt_vec_t*>(
-                  &featureTransformer.threatPsqtWeights[offset]);
+                auto*        columnPsqt = reinterpret_cast<const psqt_vec_t*>(&psqtWeights[offset]);
 
                 for (std::size_t k = 0; k < Tiling::NumPsqtRegs; ++k)
                     psqt[k] = vec_sub_psqt_32(psqt[k], columnPsqt[k]);
@@ -437,8 +603,7 @@ struct AccumulatorUpdateContext {
             {
                 size_t       index      = added[i];
                 const size_t offset     = PSQTBuckets * index + j * Tiling::PsqtTileHeight;
-                auto*        columnPsqt = reinterpret_cast<const psqt_vec_t*>(
-                  &featureTransformer.threatPsqtWeights[offset]);
+                auto*        columnPsqt = reinterpret_cast<const psqt_vec_t*>(&psqtWeights[offset]);
 
                 for (std::size_t k = 0; k < Tiling::NumPsqtRegs; ++k)
                     psqt[k] = vec_add_psqt_32(psqt[k], columnPsqt[k]);
@@ -458,10 +623,10 @@ struct AccumulatorUpdateContext {
             const IndexType offset = Dimensions * index;
 
             for (IndexType j = 0; j < Dimensions; ++j)
-                toAcc[j] -= featureTransformer.threatWeights[offset + j];
+                toAcc[j] -= weights[offset + j];
 
             for (std::size_t k = 0; k < PSQTBuckets; ++k)
-                toPsqtAcc[k] -= featureTransformer.threatPsqtWeights[index * PSQTBuckets + k];
+                toPsqtAcc[k] -= psqtWeights[index * PSQTBuckets + k];
         }
 
         for (const auto index : added)
@@ -469,14 +634,15 @@ struct AccumulatorUpdateContext {
             const IndexType offset = Dimensions * index;
 
             for (IndexType j = 0; j < Dimensions; ++j)
-                toAcc[j] += featureTransformer.threatWeights[offset + j];
+                toAcc[j] += weights[offset + j];
 
             for (std::size_t k = 0; k < PSQTBuckets; ++k)
-                toPsqtAcc[k] += featureTransformer.threatPsqtWeights[index * PSQTBuckets + k];
+                toPsqtAcc[k] += psqtWeights[index * PSQTBuckets + k];
         }
 
 #endif
     }
+
 };
 
 template<typename FeatureSet, IndexType Dimensions>
@@ -554,6 +720,8 @@ void double_inc_update(Color                                                   p
                                              &fusedData, true);
     ThreatFeatureSet::append_changed_indices(perspective, ksq, target_state.diff, removed, added,
                                              &fusedData, false);
+    featureTransformer.map_threat_rows(removed);
+    featureTransformer.map_threat_rows(added);
 
     auto updateContext =
       make_accumulator_update_context(perspective, featureTransformer, computed, target_state);
@@ -563,6 +731,123 @@ void double_inc_update(Color                                                   p
     target_state.acc<TransformedFeatureDimensions>().computed[perspective] = true;
 }
 
+template<typename FeatureSet, IndexType TransformedFeatureDimensions>
+void multi_inc_update(Color                                                   perspective,
+                      const FeatureTransformer<TransformedFeatureDimensions>& featureTransformer,
+                      const Square                                            ksq,
+                      AccumulatorState<FeatureSet>* const*                    states,
+                      std::size_t                                             count) {
+
+    constexpr IndexType Dimensions = TransformedFeatureDimensions;
+
+    assert(count <= MaxFusedPlies);
+    assert((states[0]->template acc<Dimensions>()).computed[perspective]);
+
+    std::array<typename FeatureSet::IndexList, MaxFusedPlies> removed, added;
+
+    for (std::size_t ply = 0; ply < count; ++ply)
+    {
+        FeatureSet::append_changed_indices(perspective, ksq, states[ply + 1]->diff, removed[ply],
+                                           added[ply]);
+
+        if constexpr (std::is_same_v<FeatureSet, ThreatFeatureSet>)
+        {
+            featureTransformer.map_threat_rows(removed[ply]);
+            featureTransformer.map_threat_rows(added[ply]);
+        }
+    }
+
+#ifdef VECTOR
+    using Tiling = SIMDTiling<Dimensions, Dimensions, PSQTBuckets>;
+    vec_t      acc[Tiling::NumRegs];
+    psqt_vec_t psqt[Tiling::NumPsqtRegs];
+
+    const auto* weights     = weight_rows<FeatureSet>(featureTransformer);
+    const auto* psqtWeights = psqt_weight_rows<FeatureSet>(featureTransformer);
+
+    for (IndexType j = 0; j < Dimensions / Tiling::TileHeight; ++j)
+    {
+        auto* fromTile = reinterpret_cast<const vec_t*>(
+          &(states[0]->template acc<Dimensions>())
+             .accumulation[perspective][j * Tiling::TileHeight]);
+
+        for (IndexType k = 0; k < Tiling::NumRegs; ++k)
+            acc[k] = fromTile[k];
+
+        for (std::size_t ply = 0; ply < count; ++ply)
+        {
+            for (const auto index : removed[ply])
+                update_tile<Sub, Tiling::NumRegs>(acc, &weights[Dimensions * index]);
+
+            for (const auto index : added[ply])
+                update_tile<Add, Tiling::NumRegs>(acc, &weights[Dimensions * index]);
+
+            auto* toTile = reinterpret_cast<vec_t*>(
+              &(states[ply + 1]->template acc<Dimensions>())
+                 .accumulation[perspective][j * Tiling::TileHeight]);
+
+            for (IndexType k = 0; k < Tiling::NumRegs; k++)
+                vec_store(&toTile[k], acc[k]);
+        }
+
+        weights += Tiling::TileHeight;
+    }
+
+    for (IndexType j = 0; j < PSQTBuckets / Tiling::PsqtTileHeight; ++j)
+    {
+        auto* fromTilePsqt = reinterpret_cast<const psqt_vec_t*>(
+          &(states[0]->template acc<Dimensions>())
+             .psqtAccumulation[perspective][j * Tiling::PsqtTileHeight]);
+
+        for (IndexType k = 0; k < Tiling::NumPsqtRegs; ++k)
+            psqt[k] = fromTilePsqt[k];
+
+        for (std::size_t ply = 0; ply < count; ++ply)
+        {
+            for (const auto index : removed[ply])
+            {
+                auto* columnPsqt = reinterpret_cast<const psqt_vec_t*>(
+                  &psqtWeights[PSQTBuckets * index + j * Tiling::PsqtTileHeight]);
+
+                for (std::size_t k = 0; k < Tiling::NumPsqtRegs; ++k)
+                    psqt[k] = vec_sub_psqt_32(psqt[k], columnPsqt[k]);
+            }
+
+            for (const auto index : added[ply])
+            {
+                auto* columnPsqt = reinterpret_cast<const psqt_vec_t*>(
+                  &psqtWeights[PSQTBuckets * index + j * Tiling::PsqtTileHeight]);
+
+                for (std::size_t k = 0; k < Tiling::NumPsqtRegs; ++k)
+                    psqt[k] = vec_add_psqt_32(psqt[k], columnPsqt[k]);
+            }
+
+            auto* toTilePsqt = reinterpret_cast<psqt_vec_t*>(
+              &(states[ply + 1]->template acc<Dimensions>())
+                 .psqtAccumulation[perspective][j * Tiling::PsqtTileHeight]);
+
+            for (IndexType k = 0; k < Tiling::NumPsqtRegs; ++k)
+                vec_store_psqt(&toTilePsqt[k], psqt[k]);
+        }
+    }
+
+    for (std::size_t ply = 1; ply <= count; ++ply)
+        (states[ply]->template acc<Dimensions>()).computed[perspective] = true;
+
+#else
+
+    for (std::size_t ply = 0; ply < count; ++ply)
+    {
+        auto updateContext = make_accumulator_update_context(perspective, featureTransformer,
+                                                             *states[ply], *states[ply + 1]);
+        updateContext.apply(added[ply], removed[ply]);
+
+        (states[ply + 1]->template acc<Dimensions>()).computed[perspective] = true;
+    }
+
+#endif
+}
+
 template<bool Forward, typename FeatureSet, IndexType TransformedFeatureDimensions>
 void update_accumulator_incremental(
   Color                                                   perspective,
@@ -590,7 +875,11 @@ void update_accumulator_incremental(
       make_accumulator_update_context(perspective, featureTransformer, computed, target_state);
 
     if constexpr (std::is_same_v<FeatureSet, ThreatFeatureSet>)
+    {
+        featureTransformer.map_threat_rows(removed);
+        featureTransformer.map_threat_rows(added);
         updateContext.apply(added, removed);
+    }
     else
     {
         assert(added.size() == 1 || added.size() == 2);
@@ -719,34 +1008,13 @@ void update_accumulator_refresh_cache(Color                                 pers
         int i = 0;
         for (; i < std::min(removed.ssize(), added.ssize()); ++i)
         {
-            size_t       indexR  = removed[i];
-            const size_t offsetR = Dimensions * indexR;
-            auto*        columnR = reinterpret_cast<const vec_t*>(&weights[offsetR]);
-            size_t       indexA  = added[i];
-            const size_t offsetA = Dimensions * indexA;
-            auto*        columnA = reinterpret_cast<const vec_t*>(&weights[offsetA]);
-
-            for (IndexType k = 0; k < Tiling::NumRegs; ++k)
-                acc[k] = fused<Vec16Wrapper, Add, Sub>(acc[k], columnA[k], columnR[k]);
+            update_tile<Add, Tiling::NumRegs>(acc, &weights[Dimensions * added[i]]);
+            update_tile<Sub, Tiling::NumRegs>(acc, &weights[Dimensions * removed[i]]);
         }
         for (; i < removed.ssize(); ++i)
-        {
-            size_t       index  = removed[i];
-            const size_t offset = Dimensions * index;
-            auto*        column = reinterpret_cast<const vec_t*>(&weights[offset]);
-
-            for (IndexType k = 0; k < Tiling::NumRegs; ++k)
-                acc[k] = vec_sub_16(acc[k], column[k]);
-        }
+            update_tile<Sub, Tiling::NumRegs>(acc, &weights[Dimensions * removed[i]]);
         for (; i < added.ssize(); ++i)
-        {
-            size_t       index  = added[i];
-            const size_t offset = Dimensions * index;
-            auto*        column = reinterpret_cast<const vec_t*>(&weights[offset]);
-
-            for (IndexType k = 0; k < Tiling::NumRegs; ++k)
-                acc[k] = vec_add_16(acc[k], column[k]);
-        }
+            update_tile<Add, Tiling::NumRegs>(acc, &weights[Dimensions * added[i]]);
 
         for (IndexType k = 0; k < Tiling::NumRegs; k++)
             vec_store(&entryTile[k], acc[k]);
@@ -822,14 +1090,50 @@ void update_accumulator_refresh_cache(Color                                 pers
 }
 
 template<IndexType Dimensions>
-void update_threats_accumulator_full(Color                                 perspective,
-                                     const FeatureTransformer<Dimensions>& featureTransformer,
-                                     const Position&                       pos,
-                                     AccumulatorState<ThreatFeatureSet>&   accumulatorState) {
+void update_threats_accumulator_refresh_cache(
+  Color                                 perspective,
+  const FeatureTransformer<Dimensions>& featureTransformer,
+  const Position&                       pos,
+  AccumulatorState<ThreatFeatureSet>&   accumulatorState,
+  AccumulatorCaches::Cache<Dimensions>& cache) {
     using Tiling [[maybe_unused]] = SIMDTiling<Dimensions, Dimensions, PSQTBuckets>;
 
-    ThreatFeatureSet::IndexList active;
+    ThreatFeatureSet::IndexList active, removed, added;
     ThreatFeatureSet::append_active_indices(perspective, pos, active);
+    std::sort(active.begin(), active.end());
+
+    auto& entry = cache.threat_entry(pos.square<KING>(perspective), perspective);
+
+    // Both feature lists are sorted, so the difference is a single merge pass
+    std::size_t i = 0, j = 0;
+    while (i < entry.size && j < active.size())
+    {
+        if (entry.active[i] < active[j])
+            removed.push_back(entry.active[i++]);
+        else if (active[j] < entry.active[i])
+            added.push_back(active[j++]);
+        else
+            ++i, ++j;
+    }
+    while (i < entry.size)
+        removed.push_back(entry.active[i++]);
+    while (j < active.size())
+        added.push_back(active[j++]);
+
+    // When the entry is too far from the position, rebuilding from zero
+    // touches fewer weight rows than the difference does.
+    const bool rebuild = removed.size() + added.size() > active.size();
+    if (rebuild)
+    {
+        removed = {};
+        added   = active;
+    }
+
+    std::copy(active.begin(), active.end(), entry.active.begin());
+    entry.size = IndexType(active.size());
+
+    featureTransformer.map_threat_rows(removed);
+    featureTransformer.map_threat_rows(added);
 
     auto& accumulator                 = accumulatorState.acc<Dimensions>();
     accumulator.computed[perspective] = true;
@@ -840,19 +1144,36 @@ void update_threats_accumulator_full(Color                                 persp
 
     const auto* threatWeights = &featureTransformer.threatWeights[0];
 
-    for (IndexType j = 0; j < Dimensions / Tiling::TileHeight; ++j)
+    for (IndexType t = 0; t < Dimensions / Tiling::TileHeight; ++t)
     {
         auto* accTile =
-          reinterpret_cast<vec_t*>(&accumulator.accumulation[perspective][j * Tiling::TileHeight]);
+          reinterpret_cast<vec_t*>(&accumulator.accumulation[perspective][t * Tiling::TileHeight]);
+        auto* entryTile = reinterpret_cast<vec_t*>(&entry.accumulation[t * Tiling::TileHeight]);
 
         for (IndexType k = 0; k < Tiling::NumRegs; ++k)
-            acc[k] = vec_zero();
+            acc[k] = rebuild ? vec_zero() : entryTile[k];
 
-        int i = 0;
+        for (int r = 0; r < removed.ssize(); ++r)
+        {
+            size_t       index  = removed[r];
+            const size_t offset = Dimensions * index;
+            auto*        column = reinterpret_cast<const vec_i8_t*>(&threatWeights[offset]);
 
-        for (; i < active.ssize(); ++i)
+    #ifdef USE_NEON
+            for (IndexType k = 0; k < Tiling::NumRegs; k += 2)
+            {
+                acc[k]     = vec_sub_16(acc[k], vmovl_s8(vget_low_s8(column[k / 2])));
+                acc[k + 1] = vec_sub_16(acc[k + 1], vmovl_high_s8(column[k / 2]));
+            }
+    #else
+            for (IndexType k = 0; k < Tiling::NumRegs; ++k)
+                acc[k] = vec_sub_16(acc[k], vec_convert_8_16(column[k]));
+    #endif
+        }
+
+        for (int a = 0; a < added.ssize(); ++a)
         {
-            size_t       index  = active[i];
+            size_t       index  = added[a];
             const size_t offset = Dimensions * index;
             auto*        column = reinterpret_cast<const vec_i8_t*>(&threatWeights[offset]);
 
@@ -868,24 +1189,38 @@ void update_threats_accumulator_full(Color                                 persp
     #endif
         }
 
+        for (IndexType k = 0; k < Tiling::NumRegs; k++)
+            vec_store(&entryTile[k], acc[k]);
         for (IndexType k = 0; k < Tiling::NumRegs; k++)
             vec_store(&accTile[k], acc[k]);
 
         threatWeights += Tiling::TileHeight;
     }
 
-    for (IndexType j = 0; j < PSQTBuckets / Tiling::PsqtTileHeight; ++j)
+    for (IndexType t = 0; t < PSQTBuckets / Tiling::PsqtTileHeight; ++t)
     {
         auto* accTilePsqt = reinterpret_cast<psqt_vec_t*>(
-          &accumulator.psqtAccumulation[perspective][j * Tiling::PsqtTileHeight]);
+          &accumulator.psqtAccumulation[perspective][t * Tiling::PsqtTileHeight]);
+        auto* entryTilePsqt =
+          reinterpret_cast<psqt_vec_t*>(&entry.psqtAccumulation[t * Tiling::PsqtTileHeight]);
 
         for (IndexType k = 0; k < Tiling::NumPsqtRegs; ++k)
-            psqt[k] = vec_zero_psqt();
+            psqt[k] = rebuild ? vec_zero_psqt() : entryTilePsqt[k];
 
-        for (int i = 0; i < active.ssize(); ++i)
+        for (int r = 0; r < removed.ssize(); ++r)
         {
-            size_t       index  = active[i];
-            const size_t offset = PSQTBuckets * index + j * Tiling::PsqtTileHeight;
+            size_t       index  = removed[r];
+            const size_t offset = PSQTBuckets * index + t * Tiling::PsqtTileHeight;
+            auto*        columnPsqt =
+              reinterpret_cast<const psqt_vec_t*>(&featureTransformer.threatPsqtWeights[offset]);
+
+            for (std::size_t k = 0; k < Tiling::NumPsqtRegs; ++k)
+                psqt[k] = vec_sub_psqt_32(psqt[k], columnPsqt[k]);
+        }
+        for (int a = 0; a < added.ssize(); ++a)
+        {
+            size_t       index  = added[a];
+            const size_t offset = PSQTBuckets * index + t * Tiling::PsqtTileHeight;
             auto*        columnPsqt =
               reinterpret_cast<const psqt_vec_t*>(&featureTransformer.threatPsqtWeights[offset]);
 
@@ -893,31 +1228,43 @@ void update_threats_accumulator_full(Color                                 persp
                 psqt[k] = vec_add_psqt_32(psqt[k], columnPsqt[k]);
         }
 
+        for (IndexType k = 0; k < Tiling::NumPsqtRegs; ++k)
+            vec_store_psqt(&entryTilePsqt[k], psqt[k]);
         for (IndexType k = 0; k < Tiling::NumPsqtRegs; ++k)
             vec_store_psqt(&accTilePsqt[k], psqt[k]);
     }
 
 #else
 
-    for (IndexType j = 0; j < Dimensions; ++j)
-        accumulator.accumulation[perspective][j] = 0;
-
-    for (std::size_t k = 0; k < PSQTBuckets; ++k)
-        accumulator.psqtAccumulation[perspective][k] = 0;
+    if (rebuild)
+    {
+        entry.accumulation.fill(0);
+        entry.psqtAccumulation.fill(0);
+    }
 
-    for (const auto index : active)
+    for (const auto index : removed)
     {
         const IndexType offset = Dimensions * index;
+        for (IndexType k = 0; k < Dimensions; ++k)
+            entry.accumulation[k] -= featureTransformer.threatWeights[offset + k];
 
-        for (IndexType j = 0; j < Dimensions; ++j)
-            accumulator.accumulation[perspective][j] +=
-              featureTransformer.threatWeights[offset + j];
+        for (std::size_t k = 0; k < PSQTBuckets; ++k)
+            entry.psqtAccumulation[k] -=
+              featureTransformer.threatPsqtWeights[index * PSQTBuckets + k];
+    }
+    for (const auto index : added)
+    {
+        const IndexType offset = Dimensions * index;
+        for (IndexType k = 0; k < Dimensions; ++k)
+            entry.accumulation[k] += featureTransformer.threatWeights[offset + k];
 
         for (std::size_t k = 0; k < PSQTBuckets; ++k)
-            accumulator.psqtAccumulation[perspective][k] +=
+            entry.psqtAccumulation[k] +=
               featureTransformer.threatPsqtWeights[index * PSQTBuckets + k];
     }
 
+    accumulator.accumulation[perspective]     = entry.accumulation;
+    accumulator.psqtAccumulation[perspective] = entry.psqtAccumulation;
 #endif
 }
 
@@ -25,8 +25,10 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <memory>
 #include <utility>
 
+#include "../memory.h"
 #include "../types.h"
 #include "nnue_architecture.h"
 #include "nnue_common.h"
@@ -83,16 +85,41 @@ struct AccumulatorCaches {
             }
         };
 
+        // Threat features only depend on the king through the horizontal
+        // mirroring, so threat entries are kept per half of the board. Each one
+        // stores the sorted active features its accumulation was computed from.
+        struct alignas(CacheLineSize) ThreatEntry {
+            std::array<BiasType, Size>                                   accumulation;
+            std::array<PSQTWeightType, PSQTBuckets>                      psqtAccumulation;
+            std::array<IndexType, ThreatFeatureSet::MaxActiveDimensions> active;
+            IndexType                                                    size;
+
+            // An entry without active features has an all-zero accumulation,
+            // as threat accumulators have no biases.
+            void clear() { std::memset(static_cast<void*>(this), 0, sizeof(ThreatEntry)); }
+        };
+
+        static constexpr bool UseThreats = Size == TransformedFeatureDimensionsBig;
+
         template<typename Network>
         void clear(const Network& network) {
             for (auto& entries1D : entries)
                 for (auto& entry : entries1D)
                     entry.clear(network.featureTransformer.biases);
+
+            for (auto& entries1D : threatEntries)
+                for (auto& entry : entries1D)
+                    entry.clear();
         }
 
         std::array<Entry, COLOR_NB>& operator[](Square sq) { return entries[sq]; }
 
-        std::array<std::array<Entry, COLOR_NB>, SQUARE_NB> entries;
+        ThreatEntry& threat_entry(Square ksq, Color perspective) {
+            return threatEntries[file_of(ksq) >= FILE_E][perspective];
+        }
+
+        std::array<std::array<Entry, COLOR_NB>, SQUARE_NB>                entries;
+        std::array<std::array<ThreatEntry, COLOR_NB>, UseThreats ? 2 : 0> threatEntries;
     };
 
     template<typename Networks>
@@ -149,13 +176,24 @@ struct AccumulatorState {
     }
 };
 
+// The stack is stored in pages of PagePlies plies, in a single block allocated
+// with the stack. Only the first page is constructed there; the deeper ones are
+// constructed in place on first use by the thread pushing into them, so that push()
+// never allocates and each thread only keeps resident the part of the stack it reaches.
 class AccumulatorStack {
    public:
-    static constexpr std::size_t MaxSize = MAX_PLY + 1;
+    static constexpr std::size_t MaxSize   = MAX_PLY + 1;
+    static constexpr std::size_t PagePlies = 16;
+    static constexpr std::size_t PageCount = (MaxSize + PagePlies - 1) / PagePlies;
+
+    AccumulatorStack();
 
     template<typename T>
     [[nodiscard]] const AccumulatorState<T>& latest() const noexcept;
 
+    // Bytes of accumulator pages constructed so far
+    [[nodiscard]] std::size_t resident_size() const noexcept;
+
     void                                  reset() noexcept;
     std::pair<DirtyPiece&, DirtyThreats&> push() noexcept;
     void                                  pop() noexcept;
@@ -165,15 +203,21 @@ class AccumulatorStack {
                   const FeatureTransformer<Dimensions>& featureTransformer,
                   AccumulatorCaches::Cache<Dimensions>& cache) noexcept;
 
+    void evaluate(const Position&                                              pos,
+                  const FeatureTransformer<TransformedFeatureDimensionsSmall>& smallTransformer,
+                  AccumulatorCaches::Cache<TransformedFeatureDimensionsSmall>& smallCache,
+                  const FeatureTransformer<TransformedFeatureDimensionsBig>&   bigTransformer,
+                  AccumulatorCaches::Cache<TransformedFeatureDimensionsBig>&   bigCache) noexcept;
+
    private:
     template<typename T>
     [[nodiscard]] AccumulatorState<T>& mut_latest() noexcept;
 
     template<typename T>
-    [[nodiscard]] const std::array<AccumulatorState<T>, MaxSize>& accumulators() const noexcept;
+    [[nodiscard]] const AccumulatorState<T>& state(std::size_t idx) const noexcept;
 
     template<typename T>
-    [[nodiscard]] std::array<AccumulatorState<T>, MaxSize>& mut_accumulators() noexcept;
+    [[nodiscard]] AccumulatorState<T>& mut_state(std::size_t idx) noexcept;
 
     template<typename FeatureSet, IndexType Dimensions>
     void evaluate_side(Color                                 perspective,
@@ -181,6 +225,14 @@ class AccumulatorStack {
                        const FeatureTransformer<Dimensions>& featureTransformer,
                        AccumulatorCaches::Cache<Dimensions>& cache) noexcept;
 
+    void evaluate_side_interleaved(
+      Color                                                        perspective,
+      const Position&                                              pos,
+      const FeatureTransformer<TransformedFeatureDimensionsSmall>& smallTransformer,
+      AccumulatorCaches::Cache<TransformedFeatureDimensionsSmall>& smallCache,
+      const FeatureTransformer<TransformedFeatureDimensionsBig>&   bigTransformer,
+      AccumulatorCaches::Cache<TransformedFeatureDimensionsBig>&   bigCache) noexcept;
+
     template<typename FeatureSet, IndexType Dimensions>
     [[nodiscard]] std::size_t find_last_usable_accumulator(Color perspective) const noexcept;
 
@@ -196,9 +248,14 @@ class AccumulatorStack {
                                      const FeatureTransformer<Dimensions>& featureTransformer,
                                      const std::size_t                     end) noexcept;
 
-    std::array<AccumulatorState<PSQFeatureSet>, MaxSize>    psq_accumulators;
-    std::array<AccumulatorState<ThreatFeatureSet>, MaxSize> threat_accumulators;
-    std::size_t                                             size = 1;
+    struct Page {
+        std::array<AccumulatorState<PSQFeatureSet>, PagePlies>    psq_accumulators;
+        std::array<AccumulatorState<ThreatFeatureSet>, PagePlies> threat_accumulators;
+    };
+
+    AlignedPtr<Page> pages;
+    std::size_t      constructedPages = 1;
+    std::size_t      size             = 1;
 };
 
 }  // namespace Stockfish::Eval::NNUE
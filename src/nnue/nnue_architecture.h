@@ -21,9 +21,11 @@
 #ifndef NNUE_ARCHITECTURE_H_INCLUDED
 #define NNUE_ARCHITECTURE_H_INCLUDED
 
+#include <array>
 #include <cstdint>
 #include <cstring>
 #include <iosfwd>
+#include <variant>
 
 #include "features/half_ka_v2_hm.h"
 #include "features/full_threats.h"
@@ -152,6 +154,18 @@ struct NetworkArchitecture {
     }
 };
 
+// Besides its default layer sizes, a network accepts files with the smaller
+// and larger layer stacks below, recognized at load time from the hash in the
+// file header. The feature transformer width stays fixed, as the accumulators
+// are sized by it.
+template<typename Arch>
+using LayerStackArray = std::array<Arch, LayerStacks>;
+
+template<typename Arch, IndexType L1 = Arch::TransformedFeatureDimensions>
+using LayerStackVariant = std::variant<LayerStackArray<Arch>,
+                                       LayerStackArray<NetworkArchitecture<L1, 15, 16>>,
+                                       LayerStackArray<NetworkArchitecture<L1, 31, 64>>>;
+
 }  // namespace Stockfish::Eval::NNUE
 
 template<Stockfish::Eval::NNUE::IndexType L1, int L2, int L3>
@@ -54,6 +54,14 @@ using WeightType       = std::int16_t;
 using PSQTWeightType   = std::int32_t;
 using IndexType        = std::uint32_t;
 
+// Nets with threat inputs can store their PSQ weights as int8, see
+// FeatureTransformer::PSQFeatureWeightType.
+#ifdef NNUE_PSQ_INT8
+constexpr bool PSQWeightsInt8 = true;
+#else
+constexpr bool PSQWeightsInt8 = false;
+#endif
+
 // Version of the evaluation file
 constexpr std::uint32_t Version = 0x7AF32F20u;
 
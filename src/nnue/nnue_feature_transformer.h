@@ -22,11 +22,17 @@
 #define NNUE_FEATURE_TRANSFORMER_H_INCLUDED
 
 #include <algorithm>
+#include <cassert>
 #include <cstdint>
 #include <cstring>
 #include <iosfwd>
 #include <iterator>
+#include <memory>
+#include <numeric>
+#include <type_traits>
+#include <vector>
 
+#include "../misc.h"
 #include "../position.h"
 #include "../types.h"
 #include "nnue_accumulator.h"
@@ -96,6 +102,15 @@ class FeatureTransformer {
       InputDimensions + (UseThreats ? ThreatInputDimensions : 0);
     static constexpr IndexType OutputDimensions = HalfDimensions;
 
+    // PSQ weights of nets with threat inputs are int8 in builds with
+    // -DNNUE_PSQ_INT8. They are widened on accumulation, like the threat
+    // weights, which halves the weight bandwidth of accumulator updates.
+    // The weights of other nets are doubled on load and need int16.
+    using PSQFeatureWeightType =
+      std::conditional_t<UseThreats && PSQWeightsInt8, ThreatWeightType, WeightType>;
+
+    static constexpr bool Int8PSQWeights = sizeof(PSQFeatureWeightType) == 1;
+
     // Size of forward propagation buffer
     static constexpr std::size_t BufferSize = OutputDimensions * sizeof(OutputType);
 
@@ -122,26 +137,79 @@ class FeatureTransformer {
 
     static constexpr auto InversePackusEpi16Order = invert_permutation(PackusEpi16Order);
 
-    // Hash value embedded in the evaluation file
-    static constexpr std::uint32_t get_hash_value() {
+    // Hash value embedded in the evaluation file, for PSQ weights of the given width
+    static constexpr std::uint32_t get_hash_value(bool int8PSQWeights = Int8PSQWeights) {
         return (UseThreats ? ThreatFeatureSet::HashValue : PSQFeatureSet::HashValue)
-             ^ (OutputDimensions * 2);
+             ^ (OutputDimensions * 2) ^ (int8PSQWeights ? 0x1u << 24 : 0);
     }
 
     void permute_weights() {
         permute<16>(biases, PackusEpi16Order);
-        permute<16>(weights, PackusEpi16Order);
+        permute<8 * sizeof(PSQFeatureWeightType)>(weights, PackusEpi16Order);
 
         if constexpr (UseThreats)
+        {
             permute<8>(threatWeights, PackusEpi16Order);
+            apply_threat_row_order();
+        }
     }
 
     void unpermute_weights() {
         permute<16>(biases, InversePackusEpi16Order);
-        permute<16>(weights, InversePackusEpi16Order);
+        permute<8 * sizeof(PSQFeatureWeightType)>(weights, InversePackusEpi16Order);
 
         if constexpr (UseThreats)
+        {
             permute<8>(threatWeights, InversePackusEpi16Order);
+
+            auto identity = std::make_unique<std::array<IndexType, ThreatInputDimensions>>();
+            std::iota(identity->begin(), identity->end(), 0);
+            reorder_threat_rows(*identity);
+        }
+    }
+
+    // Stores the threat weights in the rows given by ThreatFeatureSet::row_order()
+    void apply_threat_row_order() {
+        if constexpr (UseThreats)
+            reorder_threat_rows(ThreatFeatureSet::row_order());
+    }
+
+    // Threat features index the weights through threatRowOrder, which is only
+    // looked up once a ThreatOrderFile has moved the rows.
+    void map_threat_rows(ThreatFeatureSet::IndexList& indices) const {
+#ifdef NNUE_STATS
+        if (ThreatFeatureSet::recording_hits())
+            ThreatFeatureSet::record_hits(indices);
+#endif
+
+        if (threatRowsReordered)
+            for (auto& index : indices)
+                index = threatRowOrder[index];
+    }
+
+    // Prefetches the PSQ weight rows of the features changed by a move, so
+    // that they are on their way to the cache before the accumulator update
+    // at the child node. Perspectives needing a refresh use the refresh cache.
+    void prefetch_changed_rows(const Position& pos, const DirtyPiece& dp) const {
+        for (Color perspective : {WHITE, BLACK})
+        {
+            if (PSQFeatureSet::requires_refresh(dp, perspective))
+                continue;
+
+            PSQFeatureSet::IndexList removed, added;
+            PSQFeatureSet::append_changed_indices(perspective, pos.square<KING>(perspective), dp,
+                                                  removed, added);
+
+            constexpr std::size_t RowSize = sizeof(PSQFeatureWeightType) * HalfDimensions;
+
+            for (const auto* indices : {&removed, &added})
+                for (const auto index : *indices)
+                {
+                    auto* row = reinterpret_cast<const char*>(&weights[index * HalfDimensions]);
+                    for (std::size_t i = 0; i < RowSize; i += CacheLineSize)
+                        prefetch(row + i);
+                }
+        }
     }
 
     inline void scale_weights(bool read) {
@@ -151,15 +219,88 @@ class FeatureTransformer {
             b = read ? b * 2 : b / 2;
     }
 
-    // Read network parameters
-    bool read_parameters(std::istream& stream) {
+    // Moves the weights of every threat feature i to row order[i], following
+    // the cycles of the permutation to need only one spare row.
+    void reorder_threat_rows(const std::array<IndexType, ThreatInputDimensions>& order) {
+        std::vector<IndexType> source(ThreatInputDimensions);  // Row moving into each row
+        std::vector<bool>      placed(ThreatInputDimensions);
+
+        for (IndexType i = 0; i < ThreatInputDimensions; ++i)
+            source[order[i]] = threatRowOrder[i];
+
+        std::array<ThreatWeightType, HalfDimensions> spare;
+        std::array<PSQTWeightType, PSQTBuckets>      psqtSpare;
+
+        auto row      = [&](IndexType r) { return &threatWeights[r * HalfDimensions]; };
+        auto psqt_row = [&](IndexType r) { return &threatPsqtWeights[r * PSQTBuckets]; };
+
+        for (IndexType start = 0; start < ThreatInputDimensions; ++start)
+        {
+            if (placed[start])
+                continue;
+
+            std::copy_n(row(start), HalfDimensions, spare.begin());
+            std::copy_n(psqt_row(start), PSQTBuckets, psqtSpare.begin());
+
+            IndexType r = start;
+            for (; source[r] != start; r = source[r])
+            {
+                std::copy_n(row(source[r]), HalfDimensions, row(r));
+                std::copy_n(psqt_row(source[r]), PSQTBuckets, psqt_row(r));
+                placed[r] = true;
+            }
+
+            std::copy_n(spare.begin(), HalfDimensions, row(r));
+            std::copy_n(psqtSpare.begin(), PSQTBuckets, psqt_row(r));
+            placed[r] = true;
+        }
+
+        threatRowOrder      = order;
+        threatRowsReordered = false;
+
+        for (IndexType i = 0; i < ThreatInputDimensions; ++i)
+            threatRowsReordered |= order[i] != i;
+    }
+
+    // Read network parameters. With narrowPSQWeights, the PSQ weights are stored
+    // as int16 and are narrowed to int8, saturating the ones out of range. This
+    // is how int8 builds load the int16 nets, which export_net can then save.
+    bool read_parameters(std::istream& stream, bool narrowPSQWeights = false) {
+        assert(!narrowPSQWeights || Int8PSQWeights);
+
+        saturatedPSQWeights = 0;
+
         read_leb_128(stream, biases);
 
         if constexpr (UseThreats)
         {
+            std::iota(threatRowOrder.begin(), threatRowOrder.end(), 0);
+            threatRowsReordered = false;
+
             read_little_endian<ThreatWeightType>(stream, threatWeights.data(),
                                                  ThreatInputDimensions * HalfDimensions);
-            read_leb_128(stream, weights);
+            if constexpr (Int8PSQWeights)
+            {
+                if (narrowPSQWeights)
+                {
+                    auto wideWeights =
+                      std::make_unique<std::array<WeightType, HalfDimensions * InputDimensions>>();
+
+                    read_leb_128(stream, *wideWeights);
+
+                    for (IndexType i = 0; i < HalfDimensions * InputDimensions; ++i)
+                    {
+                        const WeightType w = (*wideWeights)[i];
+                        weights[i]         = std::clamp<WeightType>(w, -128, 127);
+                        saturatedPSQWeights += weights[i] != w;
+                    }
+                }
+                else
+                    read_little_endian<PSQFeatureWeightType>(stream, weights.data(),
+                                                             InputDimensions * HalfDimensions);
+            }
+            else
+                read_leb_128(stream, weights);
 
             read_leb_128(stream, threatPsqtWeights, psqtWeights);
         }
@@ -192,7 +333,11 @@ class FeatureTransformer {
         {
             write_little_endian<ThreatWeightType>(stream, copy->threatWeights.data(),
                                                   ThreatInputDimensions * HalfDimensions);
-            write_leb_128<WeightType>(stream, copy->weights);
+            if constexpr (Int8PSQWeights)
+                write_little_endian<PSQFeatureWeightType>(stream, copy->weights.data(),
+                                                          InputDimensions * HalfDimensions);
+            else
+                write_leb_128<WeightType>(stream, copy->weights);
 
             auto combinedPsqtWeights =
               std::make_unique<std::array<PSQTWeightType, TotalInputDimensions * PSQTBuckets>>();
@@ -221,6 +366,8 @@ class FeatureTransformer {
         hash_combine(h, get_raw_data_hash(biases));
         hash_combine(h, get_raw_data_hash(weights));
         hash_combine(h, get_raw_data_hash(psqtWeights));
+        if constexpr (UseThreats)
+            hash_combine(h, get_raw_data_hash(threatRowOrder));
         hash_combine(h, get_hash_value());
         return h;
     }
@@ -410,7 +557,8 @@ class FeatureTransformer {
     }  // end of function transform()
 
     alignas(CacheLineSize) std::array<BiasType, HalfDimensions> biases;
-    alignas(CacheLineSize) std::array<WeightType, HalfDimensions * InputDimensions> weights;
+    alignas(CacheLineSize)
+      std::array<PSQFeatureWeightType, HalfDimensions * InputDimensions> weights;
     alignas(CacheLineSize)
       std::array<ThreatWeightType,
                  UseThreats ? HalfDimensions * ThreatInputDimensions : 0> threatWeights;
@@ -418,6 +566,9 @@ class FeatureTransformer {
     alignas(CacheLineSize)
       std::array<PSQTWeightType,
                  UseThreats ? ThreatInputDimensions * PSQTBuckets : 0> threatPsqtWeights;
+    std::array<IndexType, UseThreats ? ThreatInputDimensions : 0> threatRowOrder;
+    bool                                                          threatRowsReordered = false;
+    std::size_t                                                   saturatedPSQWeights = 0;
 };
 
 }  // namespace Stockfish::Eval::NNUE
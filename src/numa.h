@@ -1568,6 +1568,12 @@ class LazyNumaReplicatedSystemWide: public NumaReplicatedBase {
         prepare_replicate_from(std::move(source));
     }
 
+    // Exchanges the replicated contents with another object of the same context,
+    // so that contents prepared in the background are installed without copying.
+    void swap_contents(LazyNumaReplicatedSystemWide& other) noexcept {
+        std::swap(instances, other.instances);
+    }
+
     void on_numa_config_changed() override {
         // Use the first one as the source. It doesn't matter which one we use,
         // because they all must be identical, but the first one is guaranteed to exist.
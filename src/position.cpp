@@ -27,6 +27,7 @@
 #include <initializer_list>
 #include <iomanip>
 #include <iostream>
+#include <optional>
 #include <sstream>
 #include <string_view>
 #include <utility>
@@ -43,23 +44,56 @@ using std::string;
 
 namespace Stockfish {
 
-namespace Zobrist {
-
-Key psq[PIECE_NB][SQUARE_NB];
-Key enpassant[FILE_NB];
-Key castling[CASTLING_RIGHT_NB];
-Key side, noPawns;
-
-}
-
 namespace {
 
 constexpr std::string_view PieceToChar(" PNBRQK  pnbrqk");
 
 static constexpr Piece Pieces[] = {W_PAWN, W_KNIGHT, W_BISHOP, W_ROOK, W_QUEEN, W_KING,
                                    B_PAWN, B_KNIGHT, B_BISHOP, B_ROOK, B_QUEEN, B_KING};
+
+struct ZobristKeys {
+    Key psq[PIECE_NB][SQUARE_NB];
+    Key enpassant[FILE_NB];
+    Key castling[CASTLING_RIGHT_NB];
+    Key side, noPawns;
+};
+
+// Generates at compile time the various arrays used to compute hash keys
+constexpr ZobristKeys Keys = []() {
+    ZobristKeys keys{};
+    PRNG        rng(1070372);
+
+    for (Piece pc : Pieces)
+        for (Square s = SQ_A1; s <= SQ_H8; ++s)
+            keys.psq[pc][s] = rng.rand<Key>();
+    // pawns on these squares will promote
+    for (File f = FILE_A; f <= FILE_H; ++f)
+        keys.psq[W_PAWN][make_square(f, RANK_8)] = keys.psq[B_PAWN][make_square(f, RANK_1)] = 0;
+
+    for (File f = FILE_A; f <= FILE_H; ++f)
+        keys.enpassant[f] = rng.rand<Key>();
+
+    for (int cr = NO_CASTLING; cr <= ANY_CASTLING; ++cr)
+        keys.castling[cr] = rng.rand<Key>();
+
+    keys.side    = rng.rand<Key>();
+    keys.noPawns = rng.rand<Key>();
+
+    return keys;
+}();
+
 }  // namespace
 
+namespace Zobrist {
+
+constexpr auto& psq       = Keys.psq;
+constexpr auto& enpassant = Keys.enpassant;
+constexpr auto& castling  = Keys.castling;
+constexpr auto& side      = Keys.side;
+constexpr auto& noPawns   = Keys.noPawns;
+
+}
+
 
 // Returns an ASCII representation of the position
 std::ostream& operator<<(std::ostream& os, const Position& pos) {
@@ -107,50 +141,37 @@ std::ostream& operator<<(std::ostream& os, const Position& pos) {
 // http://web.archive.org/web/20201107002606/https://marcelk.net/2013-04-06/paper/upcoming-rep-v2.pdf
 
 // First and second hash functions for indexing the cuckoo tables
-inline int H1(Key h) { return h & 0x1fff; }
-inline int H2(Key h) { return (h >> 16) & 0x1fff; }
+constexpr int H1(Key h) { return h & 0x1fff; }
+constexpr int H2(Key h) { return (h >> 16) & 0x1fff; }
 
 // Cuckoo tables with Zobrist hashes of valid reversible moves, and the moves themselves
-std::array<Key, 8192>  cuckoo;
-std::array<Move, 8192> cuckooMove;
-
-// Initializes at startup the various arrays used to compute hash keys
-void Position::init() {
-
-    PRNG rng(1070372);
-
-    for (Piece pc : Pieces)
-        for (Square s = SQ_A1; s <= SQ_H8; ++s)
-            Zobrist::psq[pc][s] = rng.rand<Key>();
-    // pawns on these squares will promote
-    std::fill_n(Zobrist::psq[W_PAWN] + SQ_A8, 8, 0);
-    std::fill_n(Zobrist::psq[B_PAWN], 8, 0);
-
-    for (File f = FILE_A; f <= FILE_H; ++f)
-        Zobrist::enpassant[f] = rng.rand<Key>();
-
-    for (int cr = NO_CASTLING; cr <= ANY_CASTLING; ++cr)
-        Zobrist::castling[cr] = rng.rand<Key>();
-
-    Zobrist::side    = rng.rand<Key>();
-    Zobrist::noPawns = rng.rand<Key>();
-
-    // Prepare the cuckoo tables
-    cuckoo.fill(0);
-    cuckooMove.fill(Move::none());
+struct CuckooTables {
+    std::array<Key, 8192>  keys;
+    std::array<Move, 8192> moves;
+};
+
+constexpr CuckooTables Cuckoo = []() {
+    CuckooTables tables{};
+    for (Move& m : tables.moves)
+        m = Move::none();
     [[maybe_unused]] int count = 0;
     for (Piece pc : Pieces)
         for (Square s1 = SQ_A1; s1 <= SQ_H8; ++s1)
             for (Square s2 = Square(s1 + 1); s2 <= SQ_H8; ++s2)
-                if ((type_of(pc) != PAWN) && (attacks_bb(type_of(pc), s1, 0) & s2))
+                if ((type_of(pc) != PAWN) && (PseudoAttacks[type_of(pc)][s1] & s2))
                 {
                     Move move = Move(s1, s2);
                     Key  key  = Zobrist::psq[pc][s1] ^ Zobrist::psq[pc][s2] ^ Zobrist::side;
                     int  i    = H1(key);
                     while (true)
                     {
-                        std::swap(cuckoo[i], key);
-                        std::swap(cuckooMove[i], move);
+                        // std::swap() is not constexpr before C++20
+                        Key  k          = tables.keys[i];
+                        Move m          = tables.moves[i];
+                        tables.keys[i]  = key;
+                        tables.moves[i] = move;
+                        key             = k;
+                        move            = m;
                         if (move == Move::none())  // Arrived at empty slot?
                             break;
                         i = (i == H1(key)) ? H2(key) : H1(key);  // Push victim to alternative slot
@@ -158,7 +179,11 @@ void Position::init() {
                     count++;
                 }
     assert(count == 3668);
-}
+    return tables;
+}();
+
+constexpr auto& cuckoo     = Cuckoo.keys;
+constexpr auto& cuckooMove = Cuckoo.moves;
 
 
 // Initializes the position object with the given FEN string.
@@ -318,9 +343,13 @@ void Position::set_castling_right(Color c, Square rfrom) {
 }
 
 
-// Sets king attacks to detect if a move gives check
+// Sets king attacks to detect if a move gives check. Called on first use of
+// the check info after a move, so nodes which are cut before looking at their
+// moves do not pay for it.
 void Position::set_check_info() const {
 
+    st->checkInfoValid = true;
+
     update_slider_blockers(WHITE);
     update_slider_blockers(BLACK);
 
@@ -461,6 +490,186 @@ string Position::fen() const {
     return ss.str();
 }
 
+
+// Initializes the position object from a packed position, as returned by
+// pack(), which must be valid. The en passant square is
+// only kept when a capture is possible, as in the FEN overload.
+Position& Position::set(const PackedPosition& pp, bool isChess960, StateInfo* si) {
+
+    auto read16 = [&](int i) { return pp.bytes[i] | pp.bytes[i + 1] << 8; };
+
+    std::memset(reinterpret_cast<char*>(this), 0, sizeof(Position));
+    std::memset(si, 0, sizeof(StateInfo));
+    st = si;
+
+    Bitboard occupied = 0, castlingRooks = 0;
+
+    for (int i = 0; i < 8; ++i)
+        occupied |= Bitboard(pp.bytes[i]) << (8 * i);
+
+    for (int i = 0; occupied; ++i)
+    {
+        Square s      = pop_lsb(occupied);
+        int    nibble = (pp.bytes[8 + i / 2] >> (4 * (i & 1))) & 0xF;
+
+        if ((nibble & 7) == 7)
+        {
+            castlingRooks |= s;
+            nibble = make_piece(Color(nibble >> 3), ROOK);
+        }
+
+        put_piece(Piece(nibble), s);
+    }
+
+    // Castling rights are set once both kings are on the board
+    while (castlingRooks)
+    {
+        Square rsq = pop_lsb(castlingRooks);
+        set_castling_right(color_of(piece_on(rsq)), rsq);
+    }
+
+    sideToMove   = Color(pp.bytes[24] & 1);
+    st->epSquare = SQ_NONE;
+    st->rule50   = read16(26);
+    gamePly      = std::max(2 * (read16(28) - 1), 0) + (sideToMove == BLACK);
+
+    // The en passant square is checked as in the FEN parser: it must be on the
+    // relative 6th rank, behind an enemy pawn that one of ours can capture.
+    if (pp.bytes[25] < SQUARE_NB)
+    {
+        Square ep = Square(pp.bytes[25]);
+
+        if (relative_rank(sideToMove, ep) == RANK_6
+            && attacks_bb<PAWN>(ep, ~sideToMove) & pieces(sideToMove, PAWN)
+            && (pieces(~sideToMove, PAWN) & (ep + pawn_push(~sideToMove)))
+            && !(pieces() & (ep | (ep + pawn_push(sideToMove)))))
+            st->epSquare = ep;
+    }
+
+    chess960 = isChess960;
+    set_state();
+
+    assert(pos_is_ok());
+
+    return *this;
+}
+
+
+// Returns the packed encoding of the position, see PackedPosition
+PackedPosition Position::pack() const {
+
+    PackedPosition pp{};
+    Bitboard       occupied = pieces(), castlingRooks = 0;
+    int            fullmove = 1 + (gamePly - (sideToMove == BLACK)) / 2;
+
+    assert(popcount(occupied) <= 32);
+
+    for (CastlingRights cr : {WHITE_OO, WHITE_OOO, BLACK_OO, BLACK_OOO})
+        if (can_castle(cr))
+            castlingRooks |= castling_rook_square(cr);
+
+    for (int i = 0; i < 8; ++i)
+        pp.bytes[i] = std::uint8_t(occupied >> (8 * i));
+
+    for (int i = 0; occupied; ++i)
+    {
+        Square s      = pop_lsb(occupied);
+        int    nibble = (castlingRooks & s) ? piece_on(s) | 7 : piece_on(s);
+
+        pp.bytes[8 + i / 2] |= std::uint8_t(nibble << (4 * (i & 1)));
+    }
+
+    pp.bytes[24] = std::uint8_t(sideToMove);
+    pp.bytes[25] = std::uint8_t(st->epSquare);
+    pp.bytes[26] = std::uint8_t(st->rule50);
+    pp.bytes[27] = std::uint8_t(st->rule50 >> 8);
+    pp.bytes[28] = std::uint8_t(fullmove);
+    pp.bytes[29] = std::uint8_t(fullmove >> 8);
+
+    return pp;
+}
+
+
+std::string PackedPosition::to_hex() const {
+
+    constexpr std::string_view Digits = "0123456789abcdef";
+
+    std::string hex;
+    for (std::uint8_t b : bytes)
+        hex += {Digits[b >> 4], Digits[b & 0xF]};
+
+    return hex;
+}
+
+
+// Checks that the pieces can be set up: no more than 32 of them, no empty nibble
+// on an occupied square, one king per side, and castling rooks on the first
+// rank of their king.
+bool PackedPosition::is_valid() const {
+
+    Bitboard occupied = 0, kings[COLOR_NB] = {}, castlingRooks[COLOR_NB] = {};
+
+    for (int i = 0; i < 8; ++i)
+        occupied |= Bitboard(bytes[i]) << (8 * i);
+
+    if (popcount(occupied) > 32)
+        return false;
+
+    for (int i = 0; occupied; ++i)
+    {
+        Square s      = pop_lsb(occupied);
+        int    nibble = (bytes[8 + i / 2] >> (4 * (i & 1))) & 0xF;
+        Color  c      = Color(nibble >> 3);
+
+        if (!(nibble & 7))
+            return false;
+
+        if ((nibble & 7) == KING)
+            kings[c] |= s;
+
+        else if ((nibble & 7) == 7)
+            castlingRooks[c] |= s;
+    }
+
+    for (Color c : {WHITE, BLACK})
+        if (popcount(kings[c]) != 1
+            || (castlingRooks[c]
+                && ((castlingRooks[c] | kings[c]) & ~rank_bb(relative_rank(c, RANK_1)))))
+            return false;
+
+    return true;
+}
+
+
+// Parses the hexadecimal form written by to_hex(). Returns nothing if the
+// string is not 64 hexadecimal digits, or if the position is not valid.
+std::optional<PackedPosition> PackedPosition::from_hex(std::string_view hex) {
+
+    auto digit = [](char c) {
+        return c >= '0' && c <= '9' ? c - '0'
+             : c >= 'a' && c <= 'f' ? c - 'a' + 10
+             : c >= 'A' && c <= 'F' ? c - 'A' + 10
+                                    : -1;
+    };
+
+    PackedPosition pp;
+
+    if (hex.size() != 2 * pp.bytes.size())
+        return std::nullopt;
+
+    for (std::size_t i = 0; i < pp.bytes.size(); ++i)
+    {
+        int hi = digit(hex[2 * i]), lo = digit(hex[2 * i + 1]);
+
+        if (hi < 0 || lo < 0)
+            return std::nullopt;
+
+        pp.bytes[i] = std::uint8_t(hi << 4 | lo);
+    }
+
+    return pp.is_valid() ? std::make_optional(pp) : std::nullopt;
+}
+
 // Calculates st->blockersForKing[c] and st->pinners[~c],
 // which store respectively the pieces preventing king of color c from being in check
 // and the slider pieces of color ~c pinning pieces of color c to the king.
@@ -697,14 +906,16 @@ bool Position::gives_check(Move m) const {
 // to a StateInfo object. The move is assumed to be legal. Pseudo-legal
 // moves should be filtered out before this function is called.
 // If a pointer to the TT table is passed, the entry for the new position
-// will be prefetched, and likewise for shared history.
+// will be prefetched, and likewise for shared history. The threat changes
+// are only listed in dts when updateThreats is set.
 void Position::do_move(Move                      m,
                        StateInfo&                newSt,
                        bool                      givesCheck,
                        DirtyPiece&               dp,
                        DirtyThreats&             dts,
-                       const TranspositionTable* tt      = nullptr,
-                       const SharedHistories*    history = nullptr) {
+                       const TranspositionTable* tt,
+                       const SharedHistories*    history,
+                       bool                      updateThreats) {
 
     assert(m.is_ok());
     assert(&newSt != st);
@@ -741,6 +952,8 @@ void Position::do_move(Move                      m,
     dts.prevKsq       = square<KING>(us);
     dts.threatenedSqs = dts.threateningSqs = 0;
 
+    DirtyThreats* const threats = updateThreats ? &dts : nullptr;
+
     assert(color_of(pc) == us);
     assert(captured == NO_PIECE || color_of(captured) == (m.type_of() != CASTLING ? them : us));
     assert(type_of(captured) != KING);
@@ -751,7 +964,7 @@ void Position::do_move(Move                      m,
         assert(captured == make_piece(us, ROOK));
 
         Square rfrom, rto;
-        do_castling<true>(us, from, to, rfrom, rto, &dts, &dp);
+        do_castling<true>(us, from, to, rfrom, rto, threats, &dp);
 
         k ^= Zobrist::psq[captured][rfrom] ^ Zobrist::psq[captured][rto];
         st->nonPawnKey[us] ^= Zobrist::psq[captured][rfrom] ^ Zobrist::psq[captured][rto];
@@ -776,7 +989,7 @@ void Position::do_move(Move                      m,
                 assert(piece_on(capsq) == make_piece(them, PAWN));
 
                 // Update board and piece lists in ep case, normal captures are updated later
-                remove_piece(capsq, &dts);
+                remove_piece(capsq, threats);
             }
 
             st->pawnKey ^= Zobrist::psq[captured][capsq];
@@ -826,11 +1039,11 @@ void Position::do_move(Move                      m,
     {
         if (captured && m.type_of() != EN_PASSANT)
         {
-            remove_piece(from, &dts);
-            swap_piece(to, pc, &dts);
+            remove_piece(from, threats);
+            swap_piece(to, pc, threats);
         }
         else
-            move_piece(from, to, &dts);
+            move_piece(from, to, threats);
     }
 
     // If the moving piece is a pawn do some special extra work
@@ -848,7 +1061,7 @@ void Position::do_move(Move                      m,
             assert(relative_rank(us, to) == RANK_8);
             assert(type_of(promotion) >= KNIGHT && type_of(promotion) <= QUEEN);
 
-            swap_piece(to, promotion, &dts);
+            swap_piece(to, promotion, threats);
 
             dp.add_pc = promotion;
             dp.add_sq = to;
@@ -904,8 +1117,8 @@ void Position::do_move(Move                      m,
 
     sideToMove = ~sideToMove;
 
-    // Update king attacks used for fast check detection
-    set_check_info();
+    // King attacks used for fast check detection are computed on first use
+    st->checkInfoValid = false;
 
     // Accurate e.p. info is needed for correct zobrist key generation and 3-fold checking
     while (checkEP)
@@ -1271,7 +1484,7 @@ void Position::do_null_move(StateInfo& newSt, const TranspositionTable& tt) {
 
     sideToMove = ~sideToMove;
 
-    set_check_info();
+    st->checkInfoValid = false;
 
     st->repetition = 0;
 
@@ -21,11 +21,14 @@
 
 #include <array>
 #include <cassert>
+#include <cstdint>
 #include <deque>
 #include <iosfwd>
 #include <memory>
 #include <new>
+#include <optional>
 #include <string>
+#include <string_view>
 
 #include "bitboard.h"
 #include "types.h"
@@ -56,11 +59,14 @@ struct StateInfo {
     Key        key;
     Bitboard   checkersBB;
     StateInfo* previous;
-    Bitboard   blockersForKing[COLOR_NB];
-    Bitboard   pinners[COLOR_NB];
-    Bitboard   checkSquares[PIECE_TYPE_NB];
     Piece      capturedPiece;
+    bool       checkInfoValid;
     int        repetition;
+
+    // Check info, computed on first use by set_check_info()
+    Bitboard blockersForKing[COLOR_NB];
+    Bitboard pinners[COLOR_NB];
+    Bitboard checkSquares[PIECE_TYPE_NB];
 };
 
 
@@ -70,14 +76,33 @@ struct StateInfo {
 // elements are not invalidated upon list resizing.
 using StateListPtr = std::unique_ptr<std::deque<StateInfo>>;
 
+// PackedPosition is a fixed-size binary encoding of a position, for tools that
+// stream large numbers of positions and would otherwise spend most of their
+// time parsing FENs. The 32 bytes are, with integers in little-endian order:
+//
+//   bytes  0-7   occupancy bitboard
+//   bytes  8-23  a nibble per occupied square, in square order and low nibble
+//                first: the Piece, or 7 (15) for a white (black) rook that
+//                still has its castling right
+//   byte  24     side to move, 0 for White and 1 for Black
+//   byte  25     en passant square, or SQ_NONE
+//   bytes 26-27  halfmove clock
+//   bytes 28-29  fullmove number
+//   bytes 30-31  zero
+struct PackedPosition {
+    std::array<std::uint8_t, 32> bytes;
+
+    bool                                 is_valid() const;
+    std::string                          to_hex() const;
+    static std::optional<PackedPosition> from_hex(std::string_view hex);
+};
+
 // Position class stores information regarding the board representation as
 // pieces, side to move, hash keys, castling info, etc. Important methods are
 // do_move() and undo_move(), used by the search to update node info when
 // traversing the search tree.
 class Position {
    public:
-    static void init();
-
     Position()                           = default;
     Position(const Position&)            = delete;
     Position& operator=(const Position&) = delete;
@@ -87,6 +112,10 @@ class Position {
     Position&   set(const std::string& code, Color c, StateInfo* si);
     std::string fen() const;
 
+    // Packed binary input/output
+    Position&      set(const PackedPosition& pp, bool isChess960, StateInfo* si);
+    PackedPosition pack() const;
+
     // Position representation
     Bitboard pieces() const;  // All pieces
     template<typename... PieceTypes>
@@ -141,7 +170,8 @@ class Position {
                  DirtyPiece&               dp,
                  DirtyThreats&             dts,
                  const TranspositionTable* tt,
-                 const SharedHistories*    worker);
+                 const SharedHistories*    worker,
+                 bool                      updateThreats);
     void undo_move(Move m);
     void do_null_move(StateInfo& newSt, const TranspositionTable& tt);
     void undo_null_move();
@@ -299,11 +329,23 @@ inline Bitboard Position::attacks_by(Color c) const {
 
 inline Bitboard Position::checkers() const { return st->checkersBB; }
 
-inline Bitboard Position::blockers_for_king(Color c) const { return st->blockersForKing[c]; }
+inline Bitboard Position::blockers_for_king(Color c) const {
+    if (!st->checkInfoValid)
+        set_check_info();
+    return st->blockersForKing[c];
+}
 
-inline Bitboard Position::pinners(Color c) const { return st->pinners[c]; }
+inline Bitboard Position::pinners(Color c) const {
+    if (!st->checkInfoValid)
+        set_check_info();
+    return st->pinners[c];
+}
 
-inline Bitboard Position::check_squares(PieceType pt) const { return st->checkSquares[pt]; }
+inline Bitboard Position::check_squares(PieceType pt) const {
+    if (!st->checkInfoValid)
+        set_check_info();
+    return st->checkSquares[pt];
+}
 
 inline Key Position::key() const { return adjust_key50(st->key); }
 
@@ -404,7 +446,7 @@ inline void Position::swap_piece(Square s, Piece pc, DirtyThreats* const dts) {
 
 inline void Position::do_move(Move m, StateInfo& newSt, const TranspositionTable* tt = nullptr) {
     new (&scratch_dts) DirtyThreats;
-    do_move(m, newSt, gives_check(m), scratch_dp, scratch_dts, tt, nullptr);
+    do_move(m, newSt, gives_check(m), scratch_dp, scratch_dts, tt, nullptr, true);
 }
 
 inline StateInfo* Position::state() const { return st; }
@@ -36,6 +36,7 @@
 #include "bitboard.h"
 #include "evaluate.h"
 #include "history.h"
+#include "learning.h"
 #include "misc.h"
 #include "movegen.h"
 #include "movepick.h"
@@ -243,6 +244,11 @@ void Search::Worker::start_searching() {
     if (bestThread != this)
         main_manager()->pv(*bestThread, threads, tt, bestThread->completedDepth);
 
+    // Results of searches restricted to some moves, or weakened, would mislead
+    // later searches of the same position.
+    if (limits.searchmoves.empty() && !skill.enabled())
+        Learning::record(rootPos, bestThread->rootMoves[0], bestThread->completedDepth);
+
     std::string ponder;
 
     if (bestThread->rootMoves[0].pv.size() > 1
@@ -253,6 +259,51 @@ void Search::Worker::start_searching() {
     main_manager()->updates.onBestmove(bestmove, ponder);
 }
 
+Value Search::Worker::search_independently(const Position& pos, const LimitsType& lim) {
+
+    // As in ThreadPool::start_thinking(), copy the root state to keep
+    // the game history needed for repetition detection.
+    rootPos.set(pos.fen(), pos.is_chess960(), &rootState);
+    rootState = *pos.state();
+
+    limits = lim;
+    nodes = tbHits = bestMoveChanges = 0;
+    nmpMinPly                        = 0;
+    rootDepth = completedDepth = selDepth = 0;
+
+    rootMoves.clear();
+    for (const auto& m : MoveList<LEGAL>(rootPos))
+        rootMoves.emplace_back(m);
+
+    if (rootMoves.empty())
+    {
+        rootMoves.emplace_back(Move::none());
+        return rootPos.checkers() ? -VALUE_MATE : VALUE_DRAW;
+    }
+
+    tbConfig        = Tablebases::rank_root_moves(options, rootPos, rootMoves);
+    smallNetOnly    = bool(options["SmallNetOnly"]);
+    useEvalCache    = bool(options["EvalCache"]);
+    speculativeEval = bool(options["SpeculativeEval"]);
+
+    accumulatorStack.reset();
+
+    independent     = true;
+    independentStop = false;
+
+    iterative_deepening();
+
+    independent = false;
+
+    const RootMove& rm = rootMoves[0];
+    Value           v  = rm.score != -VALUE_INFINITE ? rm.uciScore : rm.previousScore;
+
+    if (v == -VALUE_INFINITE)
+        v = VALUE_ZERO;
+
+    return tbConfig.rootInTB && std::abs(v) <= VALUE_TB ? rm.tbScore : v;
+}
+
 // Main iterative deepening loop. It calls search()
 // repeatedly with increasing depth until the allocated thinking time has been
 // consumed, the user stops the search, or the maximum search depth is reached.
@@ -319,8 +370,8 @@ void Search::Worker::iterative_deepening() {
               (mainHistory[c][i] - mainHistoryDefault) * 3 / 4 + mainHistoryDefault;
 
     // Iterative deepening loop until requested to stop or the target depth is reached
-    while (++rootDepth < MAX_PLY && !threads.stop
-           && !(limits.depth && mainThread && rootDepth > limits.depth))
+    while (++rootDepth < MAX_PLY && !stopped()
+           && !(limits.depth && (mainThread || independent) && rootDepth > limits.depth))
     {
         // Age out PV variability metric
         if (mainThread)
@@ -385,7 +436,7 @@ void Search::Worker::iterative_deepening() {
                 // If search has been stopped, we break immediately. Sorting is
                 // safe because RootMoves is still valid, although it refers to
                 // the previous iteration.
-                if (threads.stop)
+                if (stopped())
                     break;
 
                 // When failing high/low give some update before a re-search. To avoid
@@ -433,17 +484,17 @@ void Search::Worker::iterative_deepening() {
                 && !(threads.abortedSearch && is_loss(rootMoves[0].uciScore)))
                 main_manager()->pv(*this, threads, tt, rootDepth);
 
-            if (threads.stop)
+            if (stopped())
                 break;
         }
 
-        if (!threads.stop)
+        if (!stopped())
             completedDepth = rootDepth;
 
         // We make sure not to pick an unproven mated-in score,
         // in case this thread prematurely stopped search (aborted-search).
-        if (threads.abortedSearch && rootMoves[0].score != -VALUE_INFINITE
-            && is_loss(rootMoves[0].score))
+        if ((threads.abortedSearch || independentStop)
+            && rootMoves[0].score != -VALUE_INFINITE && is_loss(rootMoves[0].score))
         {
             // Bring the last best move to the front for best thread selection.
             Utility::move_to_front(rootMoves, [&lastBestPV = std::as_const(lastBestPV)](
@@ -555,7 +606,13 @@ void Search::Worker::do_move(
     nodes.store(nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
 
     auto [dirtyPiece, dirtyThreats] = accumulatorStack.push();
-    pos.do_move(move, st, givesCheck, dirtyPiece, dirtyThreats, &tt, &sharedHistory);
+    pos.do_move(move, st, givesCheck, dirtyPiece, dirtyThreats, &tt, &sharedHistory,
+                !smallNetOnly);
+
+#ifdef NNUE_PREFETCH_WEIGHTS
+    if (!smallNetOnly && !Eval::use_smallnet(pos))
+        networks[numaAccessToken].big.prefetch_weights(pos, dirtyPiece);
+#endif
 
     if (ss != nullptr)
     {
@@ -606,7 +663,12 @@ void Search::Worker::clear() {
     for (size_t i = 1; i < reductions.size(); ++i)
         reductions[i] = int(2747 / 128.0 * std::log(i));
 
+    clear_accumulator_caches();
+}
+
+void Search::Worker::clear_accumulator_caches() {
     refreshTable.clear(networks[numaAccessToken]);
+    evalCache.clear();
 }
 
 
@@ -666,6 +728,10 @@ Value Search::Worker::search(
     if (is_mainthread())
         main_manager()->check_time(*this);
 
+    // Independent searches have no main thread to watch their node limit
+    else if (independent && limits.nodes && nodes >= limits.nodes && completedDepth >= 1)
+        independentStop = true;
+
     // Used to send selDepth info to GUI (selDepth counts from 1, ply from 0)
     if (PvNode && selDepth < ss->ply + 1)
         selDepth = ss->ply + 1;
@@ -673,8 +739,7 @@ Value Search::Worker::search(
     if (!rootNode)
     {
         // Step 2. Check for aborted search and immediate draw
-        if (threads.stop.load(std::memory_order_relaxed) || pos.is_draw(ss->ply)
-            || ss->ply >= MAX_PLY)
+        if (stopped() || pos.is_draw(ss->ply) || ss->ply >= MAX_PLY)
             return (ss->ply >= MAX_PLY && !ss->inCheck) ? evaluate(pos) : value_draw(nodes);
 
         // Step 3. Mate distance pruning. Even if we mate at the next move our score
@@ -1076,7 +1141,7 @@ moves_loop:  // When in check, search starts here
                 // Avoid pruning sacrifices of our last piece for stalemate
                 int margin = std::max(166 * depth + captHist / 29, 0);
                 if ((alpha >= VALUE_DRAW || pos.non_pawn_material(us) != PieceValue[movedPiece])
-                    && !pos.see_ge(move, -margin))
+                    && !mp.see_ge(move, -margin))
                     continue;
             }
             else
@@ -1111,7 +1176,7 @@ moves_loop:  // When in check, search starts here
                 lmrDepth = std::max(lmrDepth, 0);
 
                 // Prune moves with negative SEE
-                if (!pos.see_ge(move, -25 * lmrDepth * lmrDepth))
+                if (!mp.see_ge(move, -25 * lmrDepth * lmrDepth))
                     continue;
             }
         }
@@ -1298,7 +1363,7 @@ moves_loop:  // When in check, search starts here
         // Finished searching the move. If a stop occurred, the return value of
         // the search cannot be trusted, and we return immediately without updating
         // best move, principal variation nor transposition table.
-        if (threads.stop.load(std::memory_order_relaxed))
+        if (stopped())
             return VALUE_ZERO;
 
         if (rootNode)
@@ -1650,7 +1715,7 @@ Value Search::Worker::qsearch(Position& pos, Stack* ss, Value alpha, Value beta)
 
                 // If static exchange evaluation is low enough
                 // we can prune this move.
-                if (!pos.see_ge(move, alpha - futilityBase))
+                if (!mp.see_ge(move, alpha - futilityBase))
                 {
                     bestValue = std::max(bestValue, std::min(alpha, futilityBase));
                     continue;
@@ -1662,7 +1727,7 @@ Value Search::Worker::qsearch(Position& pos, Stack* ss, Value alpha, Value beta)
                 continue;
 
             // Do not search moves with bad enough SEE values
-            if (!pos.see_ge(move, -80))
+            if (!mp.see_ge(move, -80))
                 continue;
         }
 
@@ -1751,9 +1816,14 @@ TimePoint Search::Worker::elapsed() const {
 
 TimePoint Search::Worker::elapsed_time() const { return main_manager()->tm.elapsed_time(); }
 
+bool Search::Worker::stopped() const {
+    return threads.stop.load(std::memory_order_relaxed) || independentStop;
+}
+
 Value Search::Worker::evaluate(const Position& pos) {
     return Eval::evaluate(networks[numaAccessToken], pos, accumulatorStack, refreshTable,
-                          optimism[pos.side_to_move()]);
+                          useEvalCache ? &evalCache : nullptr, reevalStats, smallNetOnly,
+                          speculativeEval, optimism[pos.side_to_move()]);
 }
 
 namespace {
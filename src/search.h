@@ -32,6 +32,7 @@
 #include <string_view>
 #include <vector>
 
+#include "evaluate.h"
 #include "history.h"
 #include "misc.h"
 #include "nnue/network.h"
@@ -130,6 +131,13 @@ struct LimitsType {
     bool                     ponderMode;
 };
 
+// AnalysisPosition is a root position for ThreadPool::analyse(), which
+// searches many of them concurrently, one per thread.
+struct AnalysisPosition {
+    std::string fen;
+    bool        chess960;
+};
+
 
 // The UCI stores the uci options, thread pool, and transposition table.
 // This struct is used to easily forward data to the Search::Worker class.
@@ -186,6 +194,17 @@ struct InfoIteration {
     size_t           currmovenumber;
 };
 
+struct InfoAnalysis: InfoShort {
+    size_t           index;
+    std::string_view fen;
+    int              selDepth;
+    std::string_view bound;
+    size_t           timeMs;
+    size_t           nodes;
+    std::string_view bestmove;
+    std::string_view pv;
+};
+
 // Skill structure is used to implement strength limit. If we have a UCI_Elo,
 // we convert it to an appropriate skill level, anchored to the Stash engine.
 // This method is based on a fit of the Elo results for games played between
@@ -282,10 +301,21 @@ class Worker {
     // It searches from the root position and outputs the "bestmove".
     void start_searching();
 
-    bool is_mainthread() const { return threadIdx == 0; }
+    // Searches pos on this thread alone, without the other threads of the pool,
+    // stopping on the worker's own depth or node limit. Returns the score of the
+    // best root move. Used by ThreadPool::analyse() and by self-play.
+    Value search_independently(const Position& pos, const LimitsType& limits);
+
+    const RootMoves& root_moves() const { return rootMoves; }
+
+    bool is_mainthread() const { return threadIdx == 0 && !independent; }
 
     void ensure_network_replicated();
 
+    // Refresh entries hold the biases of the networks, so they must be reset
+    // whenever other networks are installed.
+    void clear_accumulator_caches();
+
     // Public because they need to be updatable by the stats
     ButterflyHistory mainHistory;
     LowPlyHistory    lowPlyHistory;
@@ -328,11 +358,14 @@ class Worker {
 
     Value evaluate(const Position&);
 
+    bool stopped() const;
+
     LimitsType limits;
 
     size_t                pvIdx, pvLast;
     std::atomic<uint64_t> nodes, tbHits, bestMoveChanges;
     int                   selDepth, nmpMinPly;
+    bool                  independent = false, independentStop = false;
 
     Value optimism[COLOR_NB];
 
@@ -353,6 +386,15 @@ class Worker {
 
     Tablebases::Config tbConfig;
 
+    // Evaluate with the small network only, without threat features
+    bool smallNetOnly = false;
+
+    // Look up and store the network outputs in evalCache
+    bool useEvalCache = false;
+
+    // Catch up the big net accumulators whenever the small net is evaluated
+    bool speculativeEval = false;
+
     const OptionsMap&                                         options;
     ThreadPool&                                               threads;
     TranspositionTable&                                       tt;
@@ -361,6 +403,8 @@ class Worker {
     // Used by NNUE
     Eval::NNUE::AccumulatorStack  accumulatorStack;
     Eval::NNUE::AccumulatorCaches refreshTable;
+    Eval::EvalCache               evalCache;
+    Eval::ReevalStats             reevalStats;
 
     friend class Stockfish::ThreadPool;
     friend class SearchManager;
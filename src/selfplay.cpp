@@ -0,0 +1,229 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2026 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "selfplay.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "misc.h"
+#include "movegen.h"
+#include "position.h"
+#include "search.h"
+#include "thread.h"
+#include "types.h"
+
+namespace Stockfish::SelfPlay {
+
+namespace {
+
+constexpr auto   StartFEN      = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+constexpr size_t FlushSize     = 1 << 20;
+constexpr int    ProgressGames = 100;
+
+template<typename IntType>
+void append(std::vector<char>& buffer, IntType value) {
+    using UnsignedType = std::make_unsigned_t<IntType>;
+    for (size_t i = 0; i < sizeof(IntType); ++i)
+        buffer.push_back(char(UnsignedType(value) >> (8 * i)));
+}
+
+template<typename IntType>
+IntType extract(std::istream& in) {
+    using UnsignedType = std::make_unsigned_t<IntType>;
+    UnsignedType value = 0;
+    for (size_t i = 0; i < sizeof(IntType); ++i)
+        value |= UnsignedType(UnsignedType(uint8_t(in.get())) << (8 * i));
+    return IntType(value);
+}
+
+void encode(std::vector<char>& buffer, const Game& game) {
+    append<uint16_t>(buffer, uint16_t(game.startFen.size()));
+    buffer.insert(buffer.end(), game.startFen.begin(), game.startFen.end());
+    append<uint16_t>(buffer, uint16_t(game.plies.size()));
+    append<int8_t>(buffer, int8_t(game.result));
+
+    for (const auto& [move, score] : game.plies)
+    {
+        append<uint16_t>(buffer, move.raw());
+        append<int16_t>(buffer, int16_t(std::clamp(score, -VALUE_MATE, VALUE_MATE)));
+    }
+}
+
+// Plays one game from a random opening with fixed-nodes searches, adjudicating
+// it as soon as the search reports a decisive score.
+Game play_game(Search::Worker& worker, const Config& config, PRNG& rng) {
+
+    Search::LimitsType limits;
+    limits.nodes     = config.nodes;
+    limits.startTime = now();
+
+    StateListPtr states;
+    Position     pos;
+
+    // Retry until the random moves lead to a position where the game goes on
+    do
+    {
+        states = StateListPtr(new std::deque<StateInfo>(1));
+        pos.set(StartFEN, false, &states->back());
+
+        for (int i = 0; i < config.randomPlies; ++i)
+        {
+            MoveList<LEGAL> moves(pos);
+            if (!moves.size())
+                break;
+
+            states->emplace_back();
+            pos.do_move(*(moves.begin() + rng.rand<unsigned>() % moves.size()), states->back());
+        }
+    } while (!MoveList<LEGAL>(pos).size() || pos.is_draw(0));
+
+    Game game{pos.fen(), {}, 0};
+
+    while (int(game.plies.size()) < config.maxPlies && !pos.is_draw(0)
+           && pos.count<ALL_PIECES>() > 2)
+    {
+        Value v    = worker.search_independently(pos, limits);
+        Move  move = worker.root_moves()[0].pv[0];
+        int   sign = pos.side_to_move() == WHITE ? 1 : -1;
+
+        if (move == Move::none())
+        {
+            game.result = pos.checkers() ? -sign : 0;
+            break;
+        }
+
+        game.plies.emplace_back(move, v);
+
+        if (is_decisive(v))
+        {
+            game.result = v > 0 ? sign : -sign;
+            break;
+        }
+
+        states->emplace_back();
+        pos.do_move(move, states->back());
+    }
+
+    return game;
+}
+
+}  // namespace
+
+Stats generate(ThreadPool&                               threads,
+               const Config&                             config,
+               const std::function<void(const Stats&)>& onProgress) {
+
+    std::ofstream out(config.outputFile, std::ios::binary | std::ios::app);
+
+    if (!out)
+    {
+        sync_cout << "info string Unable to open file " << config.outputFile << sync_endl;
+        return {0, 0};
+    }
+
+    threads.stop = threads.abortedSearch = false;
+    threads.increaseDepth                = true;
+
+    std::atomic<uint64_t> gamesStarted{0};
+    std::mutex            mutex;
+    Stats                 stats{0, 0};
+
+    for (size_t id = 0; id < threads.num_threads(); ++id)
+    {
+        Search::Worker& worker = *(threads.begin() + id)->get()->worker;
+
+        threads.run_on_thread(id, [&, id]() {
+            PRNG              rng(now() ^ (id + 1) * 0x9E3779B97F4A7C15ULL);
+            std::vector<char> buffer;
+
+            while (gamesStarted.fetch_add(1) < config.games)
+            {
+                Game game = play_game(worker, config, rng);
+                encode(buffer, game);
+
+                std::lock_guard<std::mutex> lk(mutex);
+
+                stats.games++;
+                stats.positions += game.plies.size();
+
+                if (buffer.size() >= FlushSize)
+                {
+                    out.write(buffer.data(), std::streamsize(buffer.size()));
+                    buffer.clear();
+                }
+
+                if (stats.games % ProgressGames == 0)
+                    onProgress(stats);
+            }
+
+            std::lock_guard<std::mutex> lk(mutex);
+            out.write(buffer.data(), std::streamsize(buffer.size()));
+        });
+    }
+
+    for (size_t id = 0; id < threads.num_threads(); ++id)
+        threads.wait_on_thread(id);
+
+    return stats;
+}
+
+bool read_games(const std::string& file, const std::function<void(const Game&)>& onGame) {
+
+    std::ifstream in(file, std::ios::binary);
+
+    if (!in)
+        return false;
+
+    Game game;
+
+    while (in.peek() != std::char_traits<char>::eof())
+    {
+        game.startFen.resize(extract<uint16_t>(in));
+        in.read(game.startFen.data(), std::streamsize(game.startFen.size()));
+
+        auto plies  = extract<uint16_t>(in);
+        game.result = extract<int8_t>(in);
+        game.plies.clear();
+
+        for (int i = 0; i < plies; ++i)
+        {
+            Move  move(extract<uint16_t>(in));
+            Value score = extract<int16_t>(in);
+            game.plies.emplace_back(move, score);
+        }
+
+        if (!in)
+            return false;
+
+        onGame(game);
+    }
+
+    return true;
+}
+
+}  // namespace Stockfish::SelfPlay
@@ -0,0 +1,79 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2026 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SELFPLAY_H_INCLUDED
+#define SELFPLAY_H_INCLUDED
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "types.h"
+
+namespace Stockfish {
+
+class ThreadPool;
+
+namespace SelfPlay {
+
+// Training data is written as a stream of game records, all integers in
+// little-endian order. The positions of a game are not stored individually
+// but recovered by replaying its moves from the start position, so each
+// position costs only four bytes:
+//
+//   uint16_t  length of the start position FEN, followed by the FEN itself
+//   uint16_t  number of plies N
+//   int8_t    game result from White's point of view (1, 0 or -1)
+//   N times:  uint16_t move (Move::raw()), int16_t score of the position
+//             before the move from the side to move's point of view
+struct Config {
+    std::string outputFile  = "selfplay.bin";
+    uint64_t    games       = 1000;
+    uint64_t    nodes       = 5000;
+    int         randomPlies = 8;
+    int         maxPlies    = 400;
+};
+
+struct Game {
+    std::string                         startFen;
+    std::vector<std::pair<Move, Value>> plies;
+    int                                 result;
+};
+
+struct Stats {
+    uint64_t games;
+    uint64_t positions;
+};
+
+// Plays the requested number of fixed-nodes games, each thread of the pool
+// playing its own games with independent single-threaded searches.
+Stats generate(ThreadPool&                               threads,
+               const Config&                             config,
+               const std::function<void(const Stats&)>& onProgress);
+
+// Reads back a training data file game by game. Returns false if the file
+// cannot be opened or ends in the middle of a game record.
+bool read_games(const std::string& file, const std::function<void(const Game&)>& onGame);
+
+}  // namespace SelfPlay
+
+}  // namespace Stockfish
+
+#endif  // #ifndef SELFPLAY_H_INCLUDED
@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <atomic>
 #include <cassert>
+#include <cctype>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
@@ -33,6 +34,7 @@
 #include <string_view>
 #include <sys/stat.h>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 #include <array>
@@ -42,10 +44,12 @@
 #include "../movegen.h"
 #include "../position.h"
 #include "../search.h"
+#include "../thread.h"
 #include "../types.h"
 #include "../ucioption.h"
 
 #ifndef _WIN32
+    #include <dirent.h>
     #include <fcntl.h>
     #include <sys/mman.h>
     #include <unistd.h>
@@ -188,44 +192,49 @@ static_assert(sizeof(LR) == 3, "LR tree entry must be 3 bytes");
 
 // class TBFile memory maps/unmaps the single .rtbw and .rtbz files. Files are
 // memory mapped for best performance. Files are mapped at first access: at init
-// time only existence of the file is checked.
-class TBFile: public std::ifstream {
+// time only existence of the file is checked, in an index of the directories.
+class TBFile {
 
     std::string fname;
 
    public:
-    // Look for and open the file among the Paths directories where the .rtbw
-    // and .rtbz files can be found. Multiple directories are separated by ";"
-    // on Windows and by ":" on Unix-based operating systems.
+    // Look for the file among the Paths directories where the .rtbw and .rtbz
+    // files can be found. Multiple directories are separated by ";" on Windows
+    // and by ":" on Unix-based operating systems.
     //
     // Example:
     // C:\tb\wdl345;C:\tb\wdl6;D:\tb\dtz345;D:\tb\dtz6
     static std::string Paths;
 
+    // The tablebase files found in the Paths directories, each with its path in
+    // the first directory that holds it. Listing the directories once is much
+    // faster than trying to open the file of every possible material combination,
+    // most of which do not exist, in every directory.
+    static std::unordered_map<std::string, std::string> Index;
+
+    // Index key of a file name. File names are matched ignoring case on Windows
+    // and macOS, whose file systems do so by default, as opening them would.
+    static std::string key(std::string f) {
+#if defined(_WIN32) || defined(__APPLE__)
+        std::transform(f.begin(), f.end(), f.begin(),
+                       [](unsigned char c) { return char(std::tolower(c)); });
+#endif
+        return f;
+    }
+
+    static void index_paths();
+    static bool exists(const std::string& f) { return Index.count(key(f)); }
+
     TBFile(const std::string& f) {
 
-#ifndef _WIN32
-        constexpr char SepChar = ':';
-#else
-        constexpr char SepChar = ';';
-#endif
-        std::stringstream ss(Paths);
-        std::string       path;
+        auto it = Index.find(key(f));
 
-        while (std::getline(ss, path, SepChar))
-        {
-            fname = path + "/" + f;
-            std::ifstream::open(fname);
-            if (is_open())
-                return;
-        }
+        if (it != Index.end())
+            fname = it->second;
     }
 
     // Memory map the file and check it.
     uint8_t* map(void** baseAddress, uint64_t* mapping, TBType type) {
-        if (is_open())
-            close();  // Need to re-open to get native file descriptor
-
 #ifndef _WIN32
         struct stat statbuf;
         int         fd = ::open(fname.c_str(), O_RDONLY);
@@ -314,7 +323,56 @@ class TBFile: public std::ifstream {
     }
 };
 
-std::string TBFile::Paths;
+std::string                                  TBFile::Paths;
+std::unordered_map<std::string, std::string> TBFile::Index;
+
+void TBFile::index_paths() {
+
+#ifndef _WIN32
+    constexpr char SepChar = ':';
+#else
+    constexpr char SepChar = ';';
+#endif
+    std::stringstream ss(Paths);
+    std::string       path;
+
+    Index.clear();
+
+    auto add = [&](const std::string& f) {
+        std::string k   = key(f);
+        std::string ext = k.size() > 5 ? k.substr(k.size() - 5) : "";
+
+        if (ext == ".rtbw" || ext == ".rtbz")
+            Index.emplace(k, path + "/" + f);  // Keeps the first directory holding the file
+    };
+
+    // Files are named path + "/" + f as they always were, so an empty directory
+    // in Paths still stands for the root directory.
+    while (std::getline(ss, path, SepChar))
+    {
+#ifndef _WIN32
+        if (DIR* dir = opendir((path + "/").c_str()))
+        {
+            while (dirent* entry = readdir(dir))
+                add(entry->d_name);
+
+            closedir(dir);
+        }
+#else
+        WIN32_FIND_DATAA data;
+        HANDLE           h = FindFirstFileA((path + "\\*").c_str(), &data);
+
+        if (h != INVALID_HANDLE_VALUE)
+        {
+            do
+                add(data.cFileName);
+            while (FindNextFileA(h, &data));
+
+            FindClose(h);
+        }
+#endif
+    }
+}
 
 // struct PairsData contains low-level indexing information to access TB data.
 // There are 8, 4, or 2 PairsData records for each TBTable, according to the type
@@ -513,19 +571,12 @@ void TBTables::add(const std::vector<PieceType>& pieces) {
         code += PieceToChar[pt];
     code.insert(code.find('K', 1), "v");
 
-    TBFile file_dtz(code + ".rtbz");  // KRK -> KRvK
-    if (file_dtz.is_open())
-    {
-        file_dtz.close();
+    if (TBFile::exists(code + ".rtbz"))  // KRK -> KRvK
         foundDTZFiles++;
-    }
 
-    TBFile file(code + ".rtbw");  // KRK -> KRvK
-
-    if (!file.is_open())  // Only WDL file is checked
+    if (!TBFile::exists(code + ".rtbw"))  // Only WDL file is checked
         return;
 
-    file.close();
     foundWDLFiles++;
 
     MaxCardinality = std::max(int(pieces.size()), MaxCardinality);
@@ -553,6 +604,29 @@ void TBTables::add(const std::vector<PieceType>& pieces) {
 // Huffman codes are the same for all blocks in the table. A non-symmetric pawnless TB file
 // will have one table for wtm and one for btm, a TB file with pawns will have tables per
 // file a,b,c,d also, in this case, one set for wtm and one for btm.
+//
+// Consecutive probes of an endgame often read values of the same block. Each
+// thread keeps the state of its last walks through the Huffman symbols of a
+// few blocks, so that a walk to a later value of the block resumes where the
+// previous one stopped instead of decoding the block again from its start.
+struct BlockWalk {
+    const PairsData* d;
+    uint32_t         epoch;  // TablesEpoch when the walk was made
+    uint32_t         block;
+    int              offset;  // Offset in the block of the first value of the symbol
+    int              buf64Size;
+    uint64_t         buf64;  // Starts with the symbol
+    uint32_t*        ptr;
+};
+
+constexpr int BlockWalkCacheSize = 64;
+
+// Changed whenever the tables are released, to invalidate the cached walks. It
+// is atomic because Tablebases::init() may change it while other threads probe.
+std::atomic<uint32_t> TablesEpoch = 1;
+
+thread_local BlockWalk BlockWalks[BlockWalkCacheSize];
+
 int decompress_pairs(PairsData* d, uint64_t idx) {
 
     // Special case where all table positions store the same value
@@ -598,16 +672,34 @@ int decompress_pairs(PairsData* d, uint64_t idx) {
     while (offset > d->blockLength[block])
         offset -= d->blockLength[block++] + 1;
 
-    // Finally, we find the start address of our block of canonical Huffman symbols
-    uint32_t* ptr = (uint32_t*) (d->data + (uint64_t(block) * d->sizeofBlock));
+    BlockWalk& walk = BlockWalks[(block ^ uint32_t(uintptr_t(d) >> 6)) & (BlockWalkCacheSize - 1)];
+    uint32_t   epoch       = TablesEpoch.load(std::memory_order_relaxed);
+    int        blockOffset = offset;
+    uint32_t*  ptr;
+    uint64_t   buf64;
+    int        buf64Size;
+    Sym        sym;
 
-    // Read the first 64 bits in our block, this is a (truncated) sequence of
-    // unknown number of symbols of unknown length but we know the first one
-    // is at the beginning of this 64-bit sequence.
-    uint64_t buf64 = number<uint64_t, BigEndian>(ptr);
-    ptr += 2;
-    int buf64Size = 64;
-    Sym sym;
+    // Resume the last walk in this block if it stopped before our value
+    if (walk.d == d && walk.block == block && walk.epoch == epoch && walk.offset <= offset)
+    {
+        ptr       = walk.ptr;
+        buf64     = walk.buf64;
+        buf64Size = walk.buf64Size;
+        offset -= walk.offset;
+    }
+    else
+    {
+        // Finally, we find the start address of our block of canonical Huffman symbols
+        ptr = (uint32_t*) (d->data + (uint64_t(block) * d->sizeofBlock));
+
+        // Read the first 64 bits in our block, this is a (truncated) sequence of
+        // unknown number of symbols of unknown length but we know the first one
+        // is at the beginning of this 64-bit sequence.
+        buf64 = number<uint64_t, BigEndian>(ptr);
+        ptr += 2;
+        buf64Size = 64;
+    }
 
     while (true)
     {
@@ -645,6 +737,8 @@ int decompress_pairs(PairsData* d, uint64_t idx) {
         }
     }
 
+    walk = {d, epoch, block, blockOffset - offset, buf64Size, buf64, ptr};
+
     // Now we have our symbol that expands into d->symlen[sym] + 1 symbols.
     // We binary-search for our value recursively expanding into the left and
     // right child symbols until we reach a leaf node where symlen[sym] + 1 == 1
@@ -1340,6 +1434,77 @@ WDLScore search(Position& pos, ProbeState* result) {
     return *result = OK, value;
 }
 
+// The position after a root move, with what is known about it before probing.
+// Only the probes run concurrently: they use their own copy of the position,
+// which is enough for tables that do not look at the game history.
+struct RootChild {
+    PackedPosition packed;
+    bool           zeroing, draw, repetition, mated;
+    int            value;
+    ProbeState     result;
+};
+
+std::vector<RootChild> root_children(Position& pos, const Search::RootMoves& rootMoves) {
+
+    std::vector<RootChild> children(rootMoves.size());
+    StateInfo              st;
+
+    for (std::size_t i = 0; i < rootMoves.size(); ++i)
+    {
+        RootChild& c = children[i];
+
+        pos.do_move(rootMoves[i].pv[0], st);
+
+        c.packed     = pos.pack();
+        c.zeroing    = pos.rule50_count() == 0;
+        c.draw       = pos.is_draw(1);
+        c.repetition = pos.is_repetition(1);
+        c.mated      = pos.checkers() && MoveList<LEGAL>(pos).size() == 0;
+        c.value      = 0;
+        c.result     = OK;
+
+        pos.undo_move(rootMoves[i].pv[0]);
+    }
+
+    return children;
+}
+
+// Probes the children with the given function, spread over the threads of
+// the pool, which are idle before the search, or on the calling thread if
+// there is no pool to use.
+template<typename Probe>
+void probe_children(std::vector<RootChild>& children,
+                    bool                    chess960,
+                    ThreadPool*             threads,
+                    const Probe&            probe) {
+
+    auto probeChild = [&](RootChild& c) {
+        StateInfo st;
+        Position  p;
+        p.set(c.packed, chess960, &st);
+        c.value = probe(p, c);
+    };
+
+    if (!threads || threads->num_threads() < 2 || children.size() < 2)
+    {
+        for (RootChild& c : children)
+            probeChild(c);
+        return;
+    }
+
+    std::atomic<std::size_t> next{0};
+    std::size_t              used = std::min(threads->num_threads(), children.size());
+
+    for (std::size_t id = 0; id < used; ++id)
+        threads->run_on_thread(id, [&]() {
+            for (std::size_t i; (i = next.fetch_add(1)) < children.size();)
+                probeChild(children[i]);
+        });
+
+    for (std::size_t id = 0; id < used; ++id)
+        threads->wait_on_thread(id);
+}
+
 }  // namespace
 
 
@@ -1349,12 +1514,16 @@ WDLScore search(Position& pos, ProbeState* result) {
 void Tablebases::init(const std::string& paths) {
 
     TBTables.clear();
+    TablesEpoch++;
     MaxCardinality = 0;
     TBFile::Paths  = paths;
+    TBFile::Index.clear();
 
     if (paths.empty())
         return;
 
+    TBFile::index_paths();
+
     // MapB1H1H7[] encodes a square below a1-h8 diagonal to 0..27
     int code = 0;
     for (Square s = SQ_A1; s <= SQ_H8; ++s)
@@ -1604,10 +1773,8 @@ bool Tablebases::root_probe(Position&                    pos,
                             Search::RootMoves&           rootMoves,
                             bool                         rule50,
                             bool                         rankDTZ,
-                            const std::function<bool()>& time_abort) {
-
-    ProbeState result = OK;
-    StateInfo  st;
+                            const std::function<bool()>& time_abort,
+                            ThreadPool*                  threads) {
 
     // Obtain 50-move counter for the root position
     int cnt50 = pos.rule50_count();
@@ -1615,21 +1782,25 @@ bool Tablebases::root_probe(Position&                    pos,
     // Check whether a position was repeated since the last zeroing move.
     bool rep = pos.has_repeated();
 
-    int dtz, bound = rule50 ? (MAX_DTZ / 2 - 100) : 1;
+    int bound = rule50 ? (MAX_DTZ / 2 - 100) : 1;
 
-    // Probe and rank each move
-    for (auto& m : rootMoves)
-    {
-        pos.do_move(m.pv[0], st);
+    std::vector<RootChild> children = root_children(pos, rootMoves);
+    std::atomic<bool>      aborted{false};
 
-        // Calculate dtz for the current move counting from the root position
-        if (pos.rule50_count() == 0)
+    // Probe each move, calculating dtz counting from the root position
+    probe_children(children, pos.is_chess960(), threads, [&](Position& p, RootChild& c) {
+        int dtz;
+
+        if (aborted)
+            return 0;
+
+        if (c.zeroing)
         {
             // In case of a zeroing move, dtz is one of -101/-1/0/1/101
-            WDLScore wdl = -probe_wdl(pos, &result);
+            WDLScore wdl = -probe_wdl(p, &c.result);
             dtz          = dtz_before_zeroing(wdl);
         }
-        else if ((rule50 && pos.is_draw(1)) || pos.is_repetition(1))
+        else if ((rule50 && c.draw) || c.repetition)
         {
             // In case a root move leads to a draw by repetition or 50-move rule,
             // we set dtz to zero. Note: since we are only 1 ply from the root,
@@ -1639,17 +1810,30 @@ bool Tablebases::root_probe(Position&                    pos,
         else
         {
             // Otherwise, take dtz for the new position and correct by 1 ply
-            dtz = -probe_dtz(pos, &result);
+            dtz = -probe_dtz(p, &c.result);
             dtz = dtz > 0 ? dtz + 1 : dtz < 0 ? dtz - 1 : dtz;
         }
 
         // Make sure that a mating move is assigned a dtz value of 1
-        if (pos.checkers() && dtz == 2 && MoveList<LEGAL>(pos).size() == 0)
+        if (c.mated && dtz == 2)
             dtz = 1;
 
-        pos.undo_move(m.pv[0]);
+        if (time_abort())
+            aborted = true;
+
+        return dtz;
+    });
+
+    if (aborted)
+        return false;
+
+    // Rank each move
+    for (std::size_t i = 0; i < rootMoves.size(); ++i)
+    {
+        auto& m   = rootMoves[i];
+        int   dtz = children[i].value;
 
-        if (time_abort() || result == FAIL)
+        if (children[i].result == FAIL)
             return false;
 
         // Better moves are ranked higher. Certain wins are ranked equally.
@@ -1680,28 +1864,27 @@ bool Tablebases::root_probe(Position&                    pos,
 // This is a fallback for the case that some or all DTZ tables are missing.
 //
 // A return value false indicates that not all probes were successful.
-bool Tablebases::root_probe_wdl(Position& pos, Search::RootMoves& rootMoves, bool rule50) {
+bool Tablebases::root_probe_wdl(Position&          pos,
+                                Search::RootMoves& rootMoves,
+                                bool               rule50,
+                                ThreadPool*        threads) {
 
     static const int WDL_to_rank[] = {-MAX_DTZ, -MAX_DTZ + 101, 0, MAX_DTZ - 101, MAX_DTZ};
 
-    ProbeState result = OK;
-    StateInfo  st;
-    WDLScore   wdl;
+    std::vector<RootChild> children = root_children(pos, rootMoves);
 
+    // Probe each move
+    probe_children(children, pos.is_chess960(), threads, [&](Position& p, RootChild& c) {
+        return c.draw ? WDLDraw : -probe_wdl(p, &c.result);
+    });
 
-    // Probe and rank each move
-    for (auto& m : rootMoves)
+    // Rank each move
+    for (std::size_t i = 0; i < rootMoves.size(); ++i)
     {
-        pos.do_move(m.pv[0], st);
+        auto&    m   = rootMoves[i];
+        WDLScore wdl = WDLScore(children[i].value);
 
-        if (pos.is_draw(1))
-            wdl = WDLDraw;
-        else
-            wdl = -probe_wdl(pos, &result);
-
-        pos.undo_move(m.pv[0]);
-
-        if (result == FAIL)
+        if (children[i].result == FAIL)
             return false;
 
         m.tbRank = WDL_to_rank[wdl + 2];
@@ -1718,7 +1901,8 @@ Config Tablebases::rank_root_moves(const OptionsMap&            options,
                                    Position&                    pos,
                                    Search::RootMoves&           rootMoves,
                                    bool                         rankDTZ,
-                                   const std::function<bool()>& time_abort) {
+                                   const std::function<bool()>& time_abort,
+                                   ThreadPool*                  threads) {
     Config config;
 
     if (rootMoves.empty())
@@ -1741,16 +1925,21 @@ Config Tablebases::rank_root_moves(const OptionsMap&            options,
 
     if (config.cardinality >= popcount(pos.pieces()) && !pos.can_castle(ANY_CASTLING))
     {
+        TimePoint start = now();
+
         // Rank moves using DTZ tables, bail out if time_abort flags zeitnot
         config.rootInTB =
-          root_probe(pos, rootMoves, options["Syzygy50MoveRule"], rankDTZ, time_abort);
+          root_probe(pos, rootMoves, options["Syzygy50MoveRule"], rankDTZ, time_abort, threads);
 
         if (!config.rootInTB && !time_abort())
         {
             // DTZ tables are missing; try to rank moves using WDL tables
-            dtz_available   = false;
-            config.rootInTB = root_probe_wdl(pos, rootMoves, options["Syzygy50MoveRule"]);
+            dtz_available = false;
+            config.rootInTB =
+              root_probe_wdl(pos, rootMoves, options["Syzygy50MoveRule"], threads);
         }
+
+        config.rankTime = now() - start;
     }
 
     if (config.rootInTB)
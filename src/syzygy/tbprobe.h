@@ -19,6 +19,7 @@
 #ifndef TBPROBE_H
 #define TBPROBE_H
 
+#include <cstdint>
 #include <functional>
 #include <string>
 #include <vector>
@@ -27,6 +28,7 @@
 namespace Stockfish {
 class Position;
 class OptionsMap;
+class ThreadPool;
 
 using Depth = int;
 
@@ -43,6 +45,8 @@ struct Config {
     bool  rootInTB    = false;
     bool  useRule50   = false;
     Depth probeDepth  = 0;
+
+    std::int64_t rankTime = 0;  // Milliseconds spent probing the root moves
 };
 
 enum WDLScore {
@@ -71,14 +75,19 @@ bool     root_probe(Position&                    pos,
                     Search::RootMoves&           rootMoves,
                     bool                         rule50,
                     bool                         rankDTZ,
-                    const std::function<bool()>& time_abort);
-bool     root_probe_wdl(Position& pos, Search::RootMoves& rootMoves, bool rule50);
+                    const std::function<bool()>& time_abort,
+                    ThreadPool*                  threads = nullptr);
+bool     root_probe_wdl(Position&          pos,
+                        Search::RootMoves& rootMoves,
+                        bool               rule50,
+                        ThreadPool*        threads = nullptr);
 Config   rank_root_moves(
     const OptionsMap&            options,
     Position&                    pos,
     Search::RootMoves&           rootMoves,
     bool                         rankDTZ    = false,
-    const std::function<bool()>& time_abort = []() { return false; });
+    const std::function<bool()>& time_abort = []() { return false; },
+    ThreadPool*                  threads    = nullptr);
 
 }  // namespace Stockfish::Tablebases
 
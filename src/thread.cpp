@@ -19,17 +19,22 @@
 #include "thread.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdlib>
 #include <deque>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
 
 #include "bitboard.h"
+#include "book.h"
 #include "history.h"
 #include "memory.h"
+#include "misc.h"
 #include "movegen.h"
 #include "search.h"
 #include "syzygy/tbprobe.h"
@@ -141,6 +146,39 @@ Search::SearchManager* ThreadPool::main_manager() { return main_thread()->worker
 uint64_t ThreadPool::nodes_searched() const { return accumulate(&Search::Worker::nodes); }
 uint64_t ThreadPool::tb_hits() const { return accumulate(&Search::Worker::tbHits); }
 
+// Largest resident size of the accumulator stacks, in bytes per thread
+size_t ThreadPool::accumulator_stack_size() const {
+
+    size_t size = 0;
+    for (auto&& th : threads)
+        size = std::max(size, th->worker->accumulatorStack.resident_size());
+    return size;
+}
+
+// Hits and probes of the eval caches of all threads
+std::pair<uint64_t, uint64_t> ThreadPool::eval_cache_stats() const {
+
+    uint64_t hits = 0, probes = 0;
+    for (auto&& th : threads)
+    {
+        hits += th->worker->evalCache.hits;
+        probes += th->worker->evalCache.probes;
+    }
+    return {hits, probes};
+}
+
+// Big net re-evaluations and small net evaluations of all threads
+std::pair<uint64_t, uint64_t> ThreadPool::reeval_stats() const {
+
+    uint64_t reevals = 0, evals = 0;
+    for (auto&& th : threads)
+    {
+        reevals += th->worker->reevalStats.bigNetReevals;
+        evals += th->worker->reevalStats.smallNetEvals;
+    }
+    return {reevals, evals};
+}
+
 static size_t next_power_of_two(uint64_t count) { return count > 1 ? (2ULL << msb(count - 1)) : 1; }
 
 // Creates/destroys threads to match the requested number.
@@ -295,6 +333,16 @@ void ThreadPool::start_thinking(const OptionsMap&  options,
 
     increaseDepth = true;
 
+    // Answer from the opening book without a real search: the root is restricted
+    // to the book move and searched to depth 1, so that it is reported through
+    // the usual bestmove path, pondering included.
+    if (options["OwnBook"] && limits.searchmoves.empty() && !limits.infinite)
+        if (Move bookMove = Book::probe(pos); bookMove != Move::none())
+        {
+            limits.searchmoves = {UCIEngine::move(bookMove, pos.is_chess960())};
+            limits.depth       = 1;
+        }
+
     Search::RootMoves rootMoves;
     const auto        legalmoves = MoveList<LEGAL>(pos);
 
@@ -310,7 +358,13 @@ void ThreadPool::start_thinking(const OptionsMap&  options,
         for (const auto& m : legalmoves)
             rootMoves.emplace_back(m);
 
-    Tablebases::Config tbConfig = Tablebases::rank_root_moves(options, pos, rootMoves);
+    // The probes of the root moves are spread over the idle threads of the pool
+    Tablebases::Config tbConfig =
+      Tablebases::rank_root_moves(options, pos, rootMoves, false, []() { return false; }, this);
+
+    if (tbConfig.rootInTB)
+        sync_cout << "info string Ranked " << rootMoves.size() << " root moves by tablebases in "
+                  << tbConfig.rankTime << " ms" << sync_endl;
 
     // After ownership transfer 'states' becomes empty, so if we stop the search
     // and call 'go' again without setting a new position states.get() == nullptr.
@@ -333,8 +387,11 @@ void ThreadPool::start_thinking(const OptionsMap&  options,
             th->worker->rootDepth = th->worker->completedDepth = 0;
             th->worker->rootMoves                              = rootMoves;
             th->worker->rootPos.set(pos.fen(), pos.is_chess960(), &th->worker->rootState);
-            th->worker->rootState = setupStates->back();
-            th->worker->tbConfig  = tbConfig;
+            th->worker->rootState       = setupStates->back();
+            th->worker->tbConfig        = tbConfig;
+            th->worker->smallNetOnly    = bool(options["SmallNetOnly"]);
+            th->worker->useEvalCache    = bool(options["EvalCache"]);
+            th->worker->speculativeEval = bool(options["SpeculativeEval"]);
         });
     }
 
@@ -344,6 +401,72 @@ void ThreadPool::start_thinking(const OptionsMap&  options,
     main_thread()->start_searching();
 }
 
+// Searches every position independently, each one on a single thread with
+// that thread's own histories and the shared TT. Threads take positions from
+// a common queue until it is exhausted, and results are reported as soon as
+// each search finishes, so their order may differ from the input order.
+void ThreadPool::analyse(const std::vector<Search::AnalysisPosition>&            positions,
+                         const Search::LimitsType&                               limits,
+                         const std::function<void(const Search::InfoAnalysis&)>& onResult) {
+
+    main_thread()->wait_for_search_finished();
+
+    stop = abortedSearch = false;
+    increaseDepth        = true;
+
+    std::atomic<size_t> next{0};
+    std::mutex          resultMutex;
+
+    for (auto&& th : threads)
+    {
+        th->run_custom_job([&, worker = th->worker.get()]() {
+            for (size_t idx; (idx = next.fetch_add(1)) < positions.size();)
+            {
+                const auto& [fen, chess960] = positions[idx];
+                TimePoint   elapsed         = now();
+
+                StateInfo st;
+                Position  pos;
+                pos.set(fen, chess960, &st);
+
+                Value v = worker->search_independently(pos, limits);
+
+                const auto& rm = worker->rootMoves[0];
+
+                std::string pv;
+                for (Move m : rm.pv)
+                    pv += UCIEngine::move(m, chess960) + " ";
+
+                if (!pv.empty())
+                    pv.pop_back();
+
+                std::string bestmove = UCIEngine::move(rm.pv[0], chess960);
+
+                Search::InfoAnalysis info;
+
+                info.index    = idx;
+                info.fen      = fen;
+                info.depth    = worker->completedDepth;
+                info.selDepth = rm.selDepth;
+                info.score    = {v, pos};
+                info.bound    = rm.scoreLowerbound ? "lowerbound"
+                              : rm.scoreUpperbound ? "upperbound"
+                                                   : "";
+                info.timeMs   = now() - elapsed;
+                info.nodes    = worker->nodes;
+                info.bestmove = bestmove;
+                info.pv       = pv;
+
+                std::lock_guard<std::mutex> lk(resultMutex);
+                onResult(info);
+            }
+        });
+    }
+
+    for (auto&& th : threads)
+        th->wait_for_search_finished();
+}
+
 Thread* ThreadPool::get_best_thread() const {
 
     Thread* bestThread = threads.front().get();
@@ -453,4 +576,12 @@ void ThreadPool::ensure_network_replicated() {
         th->ensure_network_replicated();
 }
 
+void ThreadPool::clear_accumulator_caches() {
+    for (auto&& th : threads)
+        th->run_custom_job([&th]() { th->worker->clear_accumulator_caches(); });
+
+    for (auto&& th : threads)
+        th->wait_for_search_finished();
+}
+
 }  // namespace Stockfish
@@ -26,6 +26,7 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <utility>
 #include <vector>
 
 #include "memory.h"
@@ -133,6 +134,9 @@ class ThreadPool {
     ThreadPool& operator=(ThreadPool&&)      = delete;
 
     void   start_thinking(const OptionsMap&, Position&, StateListPtr&, Search::LimitsType);
+    void   analyse(const std::vector<Search::AnalysisPosition>&,
+                   const Search::LimitsType&,
+                   const std::function<void(const Search::InfoAnalysis&)>&);
     void   run_on_thread(size_t threadId, std::function<void()> f);
     void   wait_on_thread(size_t threadId);
     size_t num_threads() const;
@@ -145,13 +149,17 @@ class ThreadPool {
     Thread*                main_thread() const { return threads.front().get(); }
     uint64_t               nodes_searched() const;
     uint64_t               tb_hits() const;
+    size_t                 accumulator_stack_size() const;
     Thread*                get_best_thread() const;
     void                   start_searching();
     void                   wait_for_search_finished() const;
 
-    std::vector<size_t> get_bound_thread_count_by_numa_node() const;
+    std::vector<size_t>           get_bound_thread_count_by_numa_node() const;
+    std::pair<uint64_t, uint64_t> eval_cache_stats() const;
+    std::pair<uint64_t, uint64_t> reeval_stats() const;
 
     void ensure_network_replicated();
+    void clear_accumulator_caches();
 
     std::atomic_bool stop, abortedSearch, increaseDepth;
 
@@ -35,6 +35,20 @@
 //
 // -DUSE_PEXT    | Add runtime support for use of pext asm-instruction. Works
 //               | only in 64-bit mode and requires hardware with pext support.
+//
+// -DNNUE_STATS  | Collect the lengths of NNUE accumulator catch-ups, printed
+//               | with the debug statistics after bench, and the threat
+//               | feature hits written by the threathist command.
+//
+// -DNNUE_PSQ_INT8 | Store the PSQ feature weights of the big net as int8.
+//                 | Needs nets exported with int8 PSQ weights.
+//
+// -DNNUE_PREFETCH_WEIGHTS | Prefetch the big net PSQ weight rows of the
+//                         | features changed by a move when it is made.
+//
+// -DCONSTEXPR_MAGICS | Generate the slider attack tables at compile time, so
+//                    | they are shared read-only data instead of being built
+//                    | at startup. Slow to compile, use 'constexpr_magics=yes'.
 
     #include <cassert>
     #include <cstddef>
@@ -22,7 +22,11 @@
 #include <cctype>
 #include <cmath>
 #include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
 #include <iterator>
+#include <numeric>
 #include <optional>
 #include <sstream>
 #include <string_view>
@@ -30,9 +34,11 @@
 #include <vector>
 
 #include "benchmark.h"
+#include "book.h"
 #include "engine.h"
 #include "memory.h"
 #include "movegen.h"
+#include "nnue/features/full_threats.h"
 #include "position.h"
 #include "score.h"
 #include "search.h"
@@ -134,7 +140,10 @@ void UCIEngine::loop() {
         else if (token == "ucinewgame")
             engine.search_clear();
         else if (token == "isready")
+        {
+            engine.wait_for_networks_loaded();
             sync_cout << "readyok" << sync_endl;
+        }
 
         // Add custom non-UCI commands, mainly for debugging purposes.
         // These commands must not be used during a search!
@@ -144,6 +153,20 @@ void UCIEngine::loop() {
             bench(is);
         else if (token == BenchmarkCommand)
             benchmark(is);
+        else if (token == "analyse")
+            analyse(is);
+        else if (token == "gensfen")
+            gensfen(is);
+        else if (token == "makebook")
+            makebook(is);
+        else if (token == "threathist")
+            threathist(is);
+        else if (token == "movepickbench")
+            movepickbench(is);
+        else if (token == "posbench")
+            posbench(is);
+        else if (token == "pack")
+            pack(is);
         else if (token == "d")
             sync_cout << engine.visualize() << sync_endl;
         else if (token == "eval")
@@ -238,7 +261,9 @@ void UCIEngine::bench(std::istream& args) {
         on_update_full(i, options["UCI_ShowWDL"]);
     });
 
-    std::vector<std::string> list = Benchmark::setup_bench(engine.fen(), args);
+    std::vector<PackedPosition> packed;
+    std::vector<std::string>    list       = Benchmark::setup_bench(engine.fen(), args, packed);
+    auto                        nextPacked = packed.begin();
 
     num = count_if(list.begin(), list.end(),
                    [](const std::string& s) { return s.find("go ") == 0 || s.find("eval") == 0; });
@@ -274,6 +299,8 @@ void UCIEngine::bench(std::istream& args) {
         }
         else if (token == "setoption")
             setoption(is);
+        else if (cmd == "position packed")  // The next position of a packed file
+            engine.set_position(*nextPacked++, {});
         else if (token == "position")
             position(is);
         else if (token == "ucinewgame")
@@ -285,12 +312,18 @@ void UCIEngine::bench(std::istream& args) {
 
     elapsed = now() - elapsed + 1;  // Ensure positivity to avoid a 'divide by zero'
 
+    auto [evalCacheHits, evalCacheProbes] = engine.get_eval_cache_stats();
+    auto [bigNetReevals, smallNetEvals]   = engine.get_reeval_stats();
+
     dbg_print();
 
-    std::cerr << "\n==========================="    //
-              << "\nTotal time (ms) : " << elapsed  //
-              << "\nNodes searched  : " << nodes    //
-              << "\nNodes/second    : " << 1000 * nodes / elapsed << std::endl;
+    std::cerr << "\n==========================="                   //
+              << "\nTotal time (ms) : " << elapsed                 //
+              << "\nNodes searched  : " << nodes                   //
+              << "\nNodes/second    : " << 1000 * nodes / elapsed  //
+              << "\nAcc. stack (kB) : " << engine.get_accumulator_stack_size() / 1024
+              << "\nEval cache hits : " << evalCacheHits << '/' << evalCacheProbes
+              << "\nBig net re-evals: " << bigNetReevals << '/' << smallNetEvals << std::endl;
 
     // reset callback, to not capture a dangling reference to nodesSearched
     engine.set_on_update_full([&](const auto& i) { on_update_full(i, options["UCI_ShowWDL"]); });
@@ -454,6 +487,222 @@ void UCIEngine::benchmark(std::istream& args) {
     init_search_update_listeners();
 }
 
+// Searches the positions of a bench-style list concurrently, one position per
+// thread, and streams one result line per position as soon as it is finished.
+// The arguments are the same as for bench, e.g. 'analyse 1024 8 20 tests.epd depth'
+// runs each position of tests.epd to depth 20, eight positions at a time.
+void UCIEngine::analyse(std::istream& args) {
+    std::string                           token;
+    std::vector<Search::AnalysisPosition> positions;
+    Search::LimitsType                    limits;
+
+    std::vector<PackedPosition> packed;
+    std::vector<std::string>    list       = Benchmark::setup_bench(engine.fen(), args, packed);
+    auto                        nextPacked = packed.begin();
+
+    for (const auto& cmd : list)
+    {
+        std::istringstream is(cmd);
+        is >> std::skipws >> token;
+
+        if (token == "go")
+        {
+            limits = parse_limits(is);
+            positions.push_back({engine.fen(), bool(engine.get_options()["UCI_Chess960"])});
+        }
+        else if (token == "setoption")
+            setoption(is);
+        else if (cmd == "position packed")  // The next position of a packed file
+            engine.set_position(*nextPacked++, {});
+        else if (token == "position")
+            position(is);
+        else if (token == "ucinewgame")
+            engine.search_clear();
+    }
+
+    if (limits.perft || (!limits.depth && !limits.nodes))
+    {
+        sync_cout << "info string analyse requires a depth or nodes limit" << sync_endl;
+        return;
+    }
+
+    uint64_t  nodes   = 0;
+    TimePoint elapsed = now();
+
+    engine.analyse(positions, limits, [&](const Engine::InfoAnalysis& info) {
+        nodes += info.nodes;
+        on_analysis(info);
+    });
+
+    elapsed = now() - elapsed + 1;  // Ensure positivity to avoid a 'divide by zero'
+
+    dbg_print();
+
+    std::cerr << "\n==========================="              //
+              << "\nTotal time (ms) : " << elapsed           //
+              << "\nPositions       : " << positions.size()  //
+              << "\nNodes searched  : " << nodes             //
+              << "\nNodes/second    : " << 1000 * nodes / elapsed << std::endl;
+}
+
+// Plays self-play games on all threads and appends them as training data to a
+// file, e.g. 'gensfen games 10000 nodes 5000 random_plies 8 output data.bin'.
+// See selfplay.h for the format. Threads and Hash are taken from the options.
+void UCIEngine::gensfen(std::istream& args) {
+    std::string      token;
+    SelfPlay::Config config;
+
+    while (args >> token)
+        if (token == "games")
+            args >> config.games;
+        else if (token == "nodes")
+            args >> config.nodes;
+        else if (token == "random_plies")
+            args >> config.randomPlies;
+        else if (token == "max_plies")
+            args >> config.maxPlies;
+        else if (token == "output")
+            args >> config.outputFile;
+
+    TimePoint elapsed = now();
+
+    auto report = [&](const SelfPlay::Stats& stats) {
+        TimePoint time = now() - elapsed + 1;
+        std::cerr << "\rGames: " << stats.games << '/' << config.games
+                  << " Positions: " << stats.positions
+                  << " Positions/hour: " << 3600000 * stats.positions / time << std::flush;
+    };
+
+    SelfPlay::Stats stats = engine.self_play(config, report);
+
+    elapsed = now() - elapsed + 1;  // Ensure positivity to avoid a 'divide by zero'
+
+    std::cerr << "\n==========================="             //
+              << "\nTotal time (ms) : " << elapsed          //
+              << "\nGames played    : " << stats.games      //
+              << "\nPositions       : " << stats.positions  //
+              << "\nOutput file     : " << config.outputFile << std::endl;
+}
+
+// Builds an opening book from self-play training data, using the first plies
+// of every game, e.g. 'makebook input data.bin output book.bin plies 16'.
+void UCIEngine::makebook(std::istream& args) {
+    std::string token, input = "selfplay.bin", output = "book.bin";
+    int         plies = 16;
+
+    while (args >> token)
+        if (token == "input")
+            args >> input;
+        else if (token == "output")
+            args >> output;
+        else if (token == "plies")
+            args >> plies;
+
+    uint64_t entries = Book::make(input, output, plies);
+
+    sync_cout << "info string Wrote " << entries << " book entries to " << output << sync_endl;
+}
+
+// Runs bench while recording how often each threat feature is used, and writes
+// the histogram to a file, e.g. 'threathist threats.txt 16 1 13'. Setting the
+// file as ThreatOrderFile stores the threat weights in order of use. Hits are
+// only recorded by builds with NNUE_STATS, to keep them out of the update path.
+void UCIEngine::threathist(std::istream& args) {
+    using Eval::NNUE::Features::FullThreats;
+
+    std::string file = "threat_hits.txt";
+    args >> file;
+
+#ifndef NNUE_STATS
+    sync_cout << "info string threathist needs a build with -DNNUE_STATS" << sync_endl;
+    return;
+#endif
+
+    FullThreats::start_hit_histogram();
+    bench(args);
+    std::vector<std::uint64_t> hits = FullThreats::stop_hit_histogram();
+
+    std::ofstream out(file);
+
+    for (auto count : hits)
+        out << count << '\n';
+
+    // How concentrated the accesses are: the share of hits taken by the
+    // hottest rows, which frequency ordering packs into the fewest pages.
+    std::vector<std::uint64_t> sorted = hits;
+    std::sort(sorted.rbegin(), sorted.rend());
+
+    std::uint64_t total = std::accumulate(sorted.begin(), sorted.end(), std::uint64_t(0));
+    std::uint64_t used  = std::count_if(sorted.begin(), sorted.end(), [](auto c) { return c; });
+
+    std::cerr << "\n===========================" << "\nFeature hits    : " << total
+              << "\nFeatures used   : " << used << '/' << hits.size();
+
+    for (int percent : {1, 5, 10, 25})
+    {
+        auto top = std::accumulate(sorted.begin(), sorted.begin() + sorted.size() * percent / 100,
+                                   std::uint64_t(0));
+        std::cerr << "\nHottest " << std::setw(2) << percent << "% rows : "
+                  << 100.0 * top / std::max<std::uint64_t>(total, 1) << "% of hits";
+    }
+
+    std::cerr << "\nHistogram file  : " << file << std::endl;
+}
+
+// Measures the speed of the move picker on the positions of the speedtest
+// games, e.g. 'movepickbench 200' runs every position two hundred times.
+void UCIEngine::movepickbench(std::istream& args) {
+    int iterations = 100;
+    args >> iterations;
+
+    Benchmark::MovePickStats stats = Benchmark::movepick_speed(iterations);
+
+    std::int64_t  elapsed = std::max<std::int64_t>(stats.elapsed, 1);
+    std::uint64_t moves   = std::max<std::uint64_t>(stats.moves, 1);
+
+    std::cerr << "\n==========================="                   //
+              << "\nTotal time (ms) : " << elapsed / 1000          //
+              << "\nMove pickers    : " << stats.positions         //
+              << "\nMoves picked    : " << stats.moves             //
+              << "\nns/move         : " << 1000.0 * elapsed / moves  //
+              << "\nMoves/second    : " << 1000000 * stats.moves / elapsed << std::endl;
+}
+
+// Times the Position and move generation primitives one at a time on the
+// positions of the speedtest games, e.g. 'posbench 50' runs each fifty times.
+void UCIEngine::posbench(std::istream& args) {
+    int iterations = 20;
+    args >> iterations;
+
+    std::cerr << "\n===========================\n"
+              << std::left << std::setw(22) << "Primitive" << std::right << std::setw(12)
+              << "ops" << std::setw(10) << "ns/op" << std::setw(14) << "results" << '\n';
+
+    for (const auto& s : Benchmark::position_speed(iterations))
+        std::cerr << std::left << std::setw(22) << s.name << std::right << std::setw(12) << s.ops
+                  << std::setw(10) << std::fixed << std::setprecision(1)
+                  << double(s.elapsed) / std::max<std::uint64_t>(s.ops, 1) << std::setw(14)
+                  << s.results << '\n';
+
+    std::cerr << std::defaultfloat << std::flush;
+}
+
+// Converts a file of FENs to packed positions, e.g. 'pack tests.epd tests.packed'.
+// Bench and analyse read files with the .packed extension as packed positions.
+void UCIEngine::pack(std::istream& args) {
+    std::string input, output;
+    args >> input >> output;
+
+    std::int64_t count =
+      Benchmark::pack_positions(input, output, engine.get_options()["UCI_Chess960"]);
+
+    if (count < 0)
+        sync_cout << "info string Unable to convert " << input << " to " << output << sync_endl;
+    else
+        sync_cout << "info string Wrote " << count << " packed positions to " << output
+                  << sync_endl;
+}
+
 void UCIEngine::setoption(std::istringstream& is) {
     engine.wait_for_search_finished();
     engine.get_options().setoption(is);
@@ -466,7 +715,8 @@ std::uint64_t UCIEngine::perft(const Search::LimitsType& limits) {
 }
 
 void UCIEngine::position(std::istringstream& is) {
-    std::string token, fen;
+    std::string                   token, fen;
+    std::optional<PackedPosition> packed;
 
     is >> token;
 
@@ -478,6 +728,18 @@ void UCIEngine::position(std::istringstream& is) {
     else if (token == "fen")
         while (is >> token && token != "moves")
             fen += token + " ";
+    else if (token == "packed")
+    {
+        is >> token;
+        packed = PackedPosition::from_hex(token);
+
+        if (!packed)
+            return;
+
+        // Moves are only read after a "moves" token
+        if (is >> token && token != "moves")
+            is.setstate(std::ios::failbit);
+    }
     else
         return;
 
@@ -488,7 +750,10 @@ void UCIEngine::position(std::istringstream& is) {
         moves.push_back(token);
     }
 
-    engine.set_position(fen, moves);
+    if (packed)
+        engine.set_position(*packed, moves);
+    else
+        engine.set_position(fen, moves);
 }
 
 namespace {
@@ -651,6 +916,26 @@ void UCIEngine::on_iter(const Engine::InfoIter& info) {
     sync_cout << ss.str() << sync_endl;
 }
 
+void UCIEngine::on_analysis(const Engine::InfoAnalysis& info) {
+    std::stringstream ss;
+
+    ss << "info position " << info.index + 1  //
+       << " fen " << info.fen                  //
+       << " depth " << info.depth              //
+       << " seldepth " << info.selDepth        //
+       << " score " << format_score(info.score);
+
+    if (!info.bound.empty())
+        ss << " " << info.bound;
+
+    ss << " nodes " << info.nodes        //
+       << " time " << info.timeMs        //
+       << " bestmove " << info.bestmove  //
+       << " pv " << info.pv;
+
+    sync_cout << ss.str() << sync_endl;
+}
+
 void UCIEngine::on_bestmove(std::string_view bestmove, std::string_view ponder) {
     sync_cout << "bestmove " << bestmove;
     if (!ponder.empty())
@@ -63,6 +63,13 @@ class UCIEngine {
     void          go(std::istringstream& is);
     void          bench(std::istream& args);
     void          benchmark(std::istream& args);
+    void          analyse(std::istream& args);
+    void          gensfen(std::istream& args);
+    void          makebook(std::istream& args);
+    void          threathist(std::istream& args);
+    void          movepickbench(std::istream& args);
+    void          posbench(std::istream& args);
+    void          pack(std::istream& args);
     void          position(std::istringstream& is);
     void          setoption(std::istringstream& is);
     std::uint64_t perft(const Search::LimitsType&);
@@ -71,6 +78,7 @@ class UCIEngine {
     static void on_update_full(const Engine::InfoFull& info, bool showWDL);
     static void on_iter(const Engine::InfoIter& info);
     static void on_bestmove(std::string_view bestmove, std::string_view ponder);
+    static void on_analysis(const Engine::InfoAnalysis& info);
 
     void init_search_update_listeners();
 };
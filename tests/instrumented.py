@@ -4,6 +4,7 @@ import sys
 import subprocess
 import pathlib
 import os
+import struct
 
 from testing import (
     EPD,
@@ -71,7 +72,14 @@ class TestCLI(metaclass=OrderedClassMembers):
         pass
 
     def afterAll(self):
-        pass
+        for file in [
+            "bench_tmp.packed",
+            "selfplay_tmp.bin",
+            "book_tmp.bin",
+            "threat_hits_tmp.txt",
+        ]:
+            if os.path.exists(file):
+                os.remove(file)
 
     def beforeEach(self):
         self.stockfish = None
@@ -147,6 +155,96 @@ class TestCLI(metaclass=OrderedClassMembers):
         )
         assert self.stockfish.process.returncode == 0
 
+    def test_analyse_128_threads_8_default_depth(self):
+        self.stockfish = Stockfish(
+            f"analyse 128 {get_threads()} 8 default depth".split(" "),
+            True,
+        )
+        assert self.stockfish.process.returncode == 0
+
+    def test_analyse_128_threads_1000_bench_tmp_epd_nodes(self):
+        self.stockfish = Stockfish(
+            f"analyse 128 {get_threads()} 1000 {os.path.join(PATH, 'bench_tmp.epd')} nodes".split(
+                " "
+            ),
+            True,
+        )
+        assert self.stockfish.process.returncode == 0
+
+    def test_pack_bench_tmp_epd(self):
+        self.stockfish = Stockfish(
+            f"pack {os.path.join(PATH, 'bench_tmp.epd')} bench_tmp.packed".split(" "),
+            True,
+        )
+        assert self.stockfish.process.returncode == 0
+        assert os.path.getsize("bench_tmp.packed") % 32 == 0
+        assert os.path.getsize("bench_tmp.packed") > 0
+
+    def test_bench_128_threads_3_bench_tmp_packed_depth(self):
+        self.stockfish = Stockfish(
+            f"bench 128 {get_threads()} 3 bench_tmp.packed depth".split(" "),
+            True,
+        )
+        assert self.stockfish.process.returncode == 0
+
+    def test_position_packed_round_trip(self):
+        with open(os.path.join(PATH, "bench_tmp.epd")) as f:
+            fens = [line.strip() for line in f if line.strip()]
+
+        with open("bench_tmp.packed", "rb") as f:
+            packed = f.read()
+
+        assert len(packed) == 32 * len(fens)
+
+        self.stockfish = Stockfish()
+
+        for i, fen in enumerate(fens):
+            self.stockfish.send_command(f"position packed {packed[32 * i : 32 * i + 32].hex()}")
+            self.stockfish.send_command("d")
+            self.stockfish.expect(f"Fen: {fen}")
+
+        self.stockfish.quit()
+        assert self.stockfish.close() == 0
+
+    def test_gensfen_games_2_nodes_1000(self):
+        self.stockfish = Stockfish(
+            "gensfen games 2 nodes 1000 output selfplay_tmp.bin".split(" "),
+            True,
+        )
+        assert self.stockfish.process.returncode == 0
+        assert os.path.getsize("selfplay_tmp.bin") > 0
+
+    def test_makebook_plies_8(self):
+        self.stockfish = Stockfish(
+            "makebook input selfplay_tmp.bin output book_tmp.bin plies 8".split(" "),
+            True,
+        )
+        assert self.stockfish.process.returncode == 0
+        assert os.path.getsize("book_tmp.bin") % 16 == 0
+
+    def test_threathist_depth_4(self):
+        self.stockfish = Stockfish(
+            "threathist threat_hits_tmp.txt 16 1 4".split(" "),
+            True,
+        )
+        assert self.stockfish.process.returncode == 0
+
+        # Only builds with NNUE_STATS record the threat feature hits
+        if "NNUE_STATS" not in Stockfish(["compiler"], True).process.stdout:
+            assert "needs a build with -DNNUE_STATS" in self.stockfish.process.stdout
+            return
+
+        with open("threat_hits_tmp.txt") as f:
+            assert len(f.readlines()) == 79856
+
+    def test_movepickbench_2(self):
+        self.stockfish = Stockfish("movepickbench 2".split(" "), True)
+        assert self.stockfish.process.returncode == 0
+
+    def test_posbench_2(self):
+        self.stockfish = Stockfish("posbench 2".split(" "), True)
+        assert self.stockfish.process.returncode == 0
+
     def test_d(self):
         self.stockfish = Stockfish("d".split(" "), True)
         assert self.stockfish.process.returncode == 0
@@ -291,6 +389,30 @@ class TestInteractive(metaclass=OrderedClassMembers):
     def test_clear_hash(self):
         self.stockfish.send_command("setoption name Clear Hash")
 
+    def test_small_net_only_go_depth_12(self):
+        self.stockfish.send_command("setoption name SmallNetOnly value true")
+        self.stockfish.send_command("ucinewgame")
+        self.stockfish.send_command("position startpos moves e2e4 c7c5")
+        self.stockfish.send_command("go depth 12")
+        self.stockfish.starts_with("bestmove")
+        self.stockfish.send_command("setoption name SmallNetOnly value false")
+
+    def test_eval_cache_go_depth_12(self):
+        self.stockfish.send_command("setoption name EvalCache value true")
+        self.stockfish.send_command("ucinewgame")
+        self.stockfish.send_command("position startpos moves e2e4 c7c5")
+        self.stockfish.send_command("go depth 12")
+        self.stockfish.starts_with("bestmove")
+        self.stockfish.send_command("setoption name EvalCache value false")
+
+    def test_speculative_eval_go_depth_12(self):
+        self.stockfish.send_command("setoption name SpeculativeEval value true")
+        self.stockfish.send_command("ucinewgame")
+        self.stockfish.send_command("position fen 4k3/8/8/8/8/8/4P3/1NBQK3 w - - 0 1")
+        self.stockfish.send_command("go depth 12")
+        self.stockfish.starts_with("bestmove")
+        self.stockfish.send_command("setoption name SpeculativeEval value false")
+
     def test_fen_position_mate_1(self):
         self.stockfish.send_command("ucinewgame")
         self.stockfish.send_command(
@@ -411,6 +533,84 @@ class TestInteractive(metaclass=OrderedClassMembers):
 
         self.stockfish.send_command("setoption name Skill Level value 20")
 
+    def test_own_book_startpos(self):
+        # Polyglot entries, sorted by the standard keys of the start position and
+        # of the position after e2e4: key, move g1f3 or e7e5 (to square in bits
+        # 0-5, from square in bits 6-11), weight and learn.
+        with open("book_probe_tmp.bin", "wb") as f:
+            f.write(struct.pack(">QHHI", 0x463B96181691FC9C, 21 | 6 << 6, 1, 0))
+            f.write(struct.pack(">QHHI", 0x823C9B50FD114196, 36 | 52 << 6, 1, 0))
+
+        self.stockfish.send_command("setoption name BookFile value book_probe_tmp.bin")
+        self.stockfish.expect("info string Found 2 book entries in book_probe_tmp.bin")
+        self.stockfish.send_command("setoption name OwnBook value true")
+        self.stockfish.send_command("position startpos")
+        self.stockfish.send_command("go depth 10")
+        self.stockfish.starts_with("bestmove g1f3")
+        self.stockfish.send_command("position startpos moves e2e4")
+        self.stockfish.send_command("go depth 10")
+        self.stockfish.starts_with("bestmove e7e5")
+        self.stockfish.send_command("position startpos moves e2e4 e7e5")
+        self.stockfish.send_command("go depth 1")
+        self.stockfish.starts_with("bestmove")
+
+        self.stockfish.send_command("setoption name OwnBook value false")
+        self.stockfish.send_command("setoption name BookFile value <empty>")
+        os.remove("book_probe_tmp.bin")
+
+    def test_position_packed_invalid(self):
+        fen = "rnbqkbnr/pp2pppp/8/2ppP3/8/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 3"
+        self.stockfish.send_command(f"position fen {fen}")
+
+        # 40 occupied squares, then an empty nibble on an occupied square
+        for packed in (
+            "ffffffffff00f3ff275336721111119119999999afdbbefa002b000003000000",
+            "ffef00001c00f3ff205336721111119119999999afdbbefa002b000003000000",
+        ):
+            self.stockfish.send_command(f"position packed {packed}")
+            self.stockfish.send_command("d")
+            self.stockfish.expect(f"Fen: {fen}")
+
+        # An en passant square on a3 with White to move is dropped
+        self.stockfish.send_command(
+            "position packed ffef00001c00f3ff275336721111119119999999afdbbefa0010000003000000"
+        )
+        self.stockfish.send_command("d")
+        self.stockfish.expect(
+            "Fen: rnbqkbnr/pp2pppp/8/2ppP3/8/8/PPPP1PPP/RNBQKBNR w KQkq - 0 3"
+        )
+
+        # Moves are only read after a "moves" token
+        startpos = "ffff00000000ffff275336721111111199999999afdbbefa0040000001000000"
+        self.stockfish.send_command(f"position packed {startpos} foo e2e4")
+        self.stockfish.send_command("d")
+        self.stockfish.expect(
+            "Fen: rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
+        )
+
+    def test_syzygy_path_file_names(self):
+        # Only the file names are checked when setting the path, so empty files
+        # are enough. Differently cased names are found where the file system
+        # ignores case.
+        names = ["KRvK.rtbw", "kqvk.rtbw", "KPvK.RTBW"]
+        os.makedirs("syzygy_tmp", exist_ok=True)
+        for name in names:
+            open(os.path.join("syzygy_tmp", name), "wb").close()
+
+        found = 3 if sys.platform in ("win32", "darwin") else 1
+        paths = os.pathsep.join(
+            ["syzygy_missing_tmp", "", os.path.abspath("syzygy_tmp")]
+        )
+        self.stockfish.send_command(f"setoption name SyzygyPath value {paths}")
+        self.stockfish.expect(
+            f"info string Found {found} WDL and 0 DTZ tablebase files (up to 3-man)."
+        )
+
+        self.stockfish.send_command("setoption name SyzygyPath value <empty>")
+        for name in names:
+            os.remove(os.path.join("syzygy_tmp", name))
+        os.rmdir("syzygy_tmp")
+
 
 class TestSyzygy(metaclass=OrderedClassMembers):
     def beforeAll(self):